@@ -37,103 +37,83 @@
  	Original: https://github.com/ReneNyffenegger/cpp-base64
 */
 
-#include "base64.h"
-
-static const std::string base64_chars = 
-             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-             "abcdefghijklmnopqrstuvwxyz"
-             "0123456789+/";
-
-
-static inline bool is_base64(unsigned char c) {
-  return (isalnum(c) || (c == '+') || (c == '/'));
+#include "Base64.h"
+
+#include <algorithm>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MISC_BASE64_SSE2
+#include <emmintrin.h>
+#endif
+
+template class Base64::BasicEncoder<Base64::Standard>;
+template class Base64::BasicEncoder<Base64::StandardNoPad>;
+template class Base64::BasicEncoder<Base64::Url>;
+template class Base64::BasicEncoder<Base64::UrlNoPad>;
+template class Base64::BasicDecoder<Base64::Standard>;
+template class Base64::BasicDecoder<Base64::StandardNoPad>;
+template class Base64::BasicDecoder<Base64::Url>;
+template class Base64::BasicDecoder<Base64::UrlNoPad>;
+
+unsigned Base64::detail::threadCount(size_t len, unsigned nThreads)
+{
+    // Each thread should get a reasonably large piece of the input, otherwise the cost of starting the thread dominates
+    size_t constexpr MIN_BYTES_PER_THREAD = 256 * 1024;
+
+    if (nThreads == 0)
+        nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    if (len < PARALLEL_THRESHOLD)
+        return 1;
+    return static_cast<unsigned>(std::min<size_t>(nThreads, len / MIN_BYTES_PER_THREAD));
 }
 
-std::string Base64::encode(unsigned char const* bytes_to_encode, size_t in_len) {
-  std::string ret;
-  int i = 0;
-  int j = 0;
-  unsigned char char_array_3[3];
-  unsigned char char_array_4[4];
-
-  while (in_len--) {
-    char_array_3[i++] = *(bytes_to_encode++);
-    if (i == 3) {
-      char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-      char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-      char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-      char_array_4[3] = char_array_3[2] & 0x3f;
-
-      for(i = 0; (i <4) ; i++)
-        ret += base64_chars[char_array_4[i]];
-      i = 0;
-    }
-  }
-
-  if (i)
-  {
-    for(j = i; j < 3; j++)
-      char_array_3[j] = '\0';
-
-    char_array_4[0] = ( char_array_3[0] & 0xfc) >> 2;
-    char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-    char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-
-    for (j = 0; (j < i + 1); j++)
-      ret += base64_chars[char_array_4[j]];
-
-    while((i++ < 3))
-      ret += '=';
-
-  }
-
-  return ret;
-
+namespace
+{
+bool isAlnumOr(char c, char c62, char c63)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == c62 || c == c63;
 }
 
-std::string Base64::decode(std::string const& encoded_string) {
-  size_t in_len = encoded_string.size();
-  int i = 0;
-  int j = 0;
-  int in_ = 0;
-  unsigned char char_array_4[4], char_array_3[3];
-  std::string ret;
-
-  while (in_len-- && ( encoded_string[in_] != '=') && is_base64(encoded_string[in_])) {
-    char_array_4[i++] = encoded_string[in_]; in_++;
-    if (i ==4) {
-      for (i = 0; i <4; i++)
-      {
-          std::string::size_type x = base64_chars.find(char_array_4[i]);
-          if (x == std::string::npos)
-              return ret;
-          char_array_4[i] = x & 0xff;
-      }
-
-      char_array_3[0] = ( char_array_4[0] << 2       ) + ((char_array_4[1] & 0x30) >> 4);
-      char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-      char_array_3[2] = ((char_array_4[2] & 0x3) << 6) +   char_array_4[3];
-
-      for (i = 0; (i < 3); i++)
-        ret += char_array_3[i];
-      i = 0;
+#if defined(MISC_BASE64_SSE2)
+// Returns a mask with 0xff in each byte that is a letter, a digit, c62, or c63
+__m128i alnumOrMask(__m128i x, __m128i c62, __m128i c63)
+{
+    // Setting bit 5 maps 'A'-'Z' onto 'a'-'z' without mapping anything else onto them. Bytes >= 0x80 are negative and
+    // fail every range test.
+    __m128i const folded = _mm_or_si128(x, _mm_set1_epi8(0x20));
+    __m128i const letter = _mm_and_si128(_mm_cmpgt_epi8(folded, _mm_set1_epi8('a' - 1)),
+                                         _mm_cmplt_epi8(folded, _mm_set1_epi8('z' + 1)));
+    __m128i const digit  = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8('0' - 1)),
+                                         _mm_cmplt_epi8(x, _mm_set1_epi8('9' + 1)));
+    __m128i const other  = _mm_or_si128(_mm_cmpeq_epi8(x, c62), _mm_cmpeq_epi8(x, c63));
+    return _mm_or_si128(_mm_or_si128(letter, digit), other);
+}
+#endif // defined(MISC_BASE64_SSE2)
+} // anonymous namespace
+
+size_t Base64::detail::findInvalidAlnum(char const * s, size_t len, char c62, char c63)
+{
+    size_t i = 0;
+
+#if defined(MISC_BASE64_SSE2)
+    // Check 64 characters at a time, with a single branch per block. The first bad block is rescanned below.
+    __m128i const v62 = _mm_set1_epi8(c62);
+    __m128i const v63 = _mm_set1_epi8(c63);
+    for (; i + 64 <= len; i += 64)
+    {
+        __m128i const * const p = reinterpret_cast<__m128i const *>(s + i);
+        __m128i const valid = _mm_and_si128(
+            _mm_and_si128(alnumOrMask(_mm_loadu_si128(p + 0), v62, v63), alnumOrMask(_mm_loadu_si128(p + 1), v62, v63)),
+            _mm_and_si128(alnumOrMask(_mm_loadu_si128(p + 2), v62, v63), alnumOrMask(_mm_loadu_si128(p + 3), v62, v63)));
+        if (_mm_movemask_epi8(valid) != 0xffff)
+            break;
     }
-  }
+#endif // defined(MISC_BASE64_SSE2)
 
-  if (i) {
-    for (j = 0; j < i; j++)
+    while (i < len && isAlnumOr(s[i], c62, c63))
     {
-        std::string::size_type x = base64_chars.find(char_array_4[j]);
-        if (x == std::string::npos)
-            return ret;
-        char_array_4[j] = x & 0xff;
+        ++i;
     }
-
-    char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-    char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-
-    for (j = 0; (j < i - 1); j++) ret += char_array_3[j];
-  }
-
-  return ret;
+    return i;
 }
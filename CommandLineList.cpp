@@ -1,93 +1,938 @@
 #include "CommandLineList.h"
 
+#include "GlobPattern.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cctype>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #if defined(WIN32)
 #include <windows.h>
 #else
+#include <dirent.h>
+#include <fcntl.h>
 #include <glob.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
-CommandLineList::CommandLineList(char const * commandLine)
+// A response file, mapped into memory copy-on-write so that its tokens can be terminated in place without changing the
+// file
+class CommandLineList::MappedFile
 {
-    bool        in_arg        = false;      // true if processing an arg
-    bool        in_quoted_arg = false;      // true if the current arg is quoted
-    std::string arg;
+public:
+
+    explicit MappedFile(char const * path);
+    ~MappedFile();
+
+    // Returns true if the file was opened and mapped
+    bool valid() const { return valid_; }
+
+    char * data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Returns a value that identifies the file, regardless of the path used to open it
+    FileId id() const { return id_; }
+
+private:
+
+    // non-copyable
+    MappedFile(MappedFile const &) = delete;
+    MappedFile & operator =(MappedFile const &) = delete;
 
-    // Scan the command line for args and add them to the list. Whitespace is ignored inside quoted args.
+    char * data_  = nullptr;
+    size_t size_  = 0;
+    FileId id_    = { 0, 0 };
+    bool   valid_ = false;
+};
 
-    for (char const * p = commandLine; *p != 0; p++)
+#if defined(WIN32)
+
+CommandLineList::MappedFile::MappedFile(char const * path)
+{
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+
+    BY_HANDLE_FILE_INFORMATION information;
+    if (GetFileInformationByHandle(file, &information))
     {
-        char const c = *p;
+        id_   = { information.dwVolumeSerialNumber,
+                  (static_cast<uint64_t>(information.nFileIndexHigh) << 32) | information.nFileIndexLow };
+        size_ = (static_cast<size_t>(information.nFileSizeHigh) << 32) | information.nFileSizeLow;
+        if (size_ == 0)
+        {
+            valid_ = true;
+        }
+        else if (HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr))
+        {
+            // The view keeps the mapping open
+            data_  = static_cast<char *>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+            valid_ = (data_ != nullptr);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+}
 
-        // Continue to append chars until white space (or a double quote for quoted args) is found. When the end of the arg is
-        // found, add it to the command line list
-        if (in_arg)
+CommandLineList::MappedFile::~MappedFile()
+{
+    if (data_)
+        UnmapViewOfFile(data_);
+}
+
+#else // defined(WIN32)
+
+CommandLineList::MappedFile::MappedFile(char const * path)
+{
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat status;
+    if (fstat(fd, &status) == 0 && S_ISREG(status.st_mode))
+    {
+        id_   = { static_cast<uint64_t>(status.st_dev), static_cast<uint64_t>(status.st_ino) };
+        size_ = static_cast<size_t>(status.st_size);
+        if (size_ == 0)
         {
-            if ((!in_quoted_arg && isspace(c)) || (in_quoted_arg && c == '"'))
+            valid_ = true;
+        }
+        else
+        {
+            // The mapping remains valid after the file is closed
+            void * p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED)
             {
-                // Add it to the list
-                include(arg.c_str());
+                madvise(p, size_, MADV_SEQUENTIAL);
+                data_  = static_cast<char *>(p);
+                valid_ = true;
+            }
+        }
+    }
+    ::close(fd);
+}
 
-                // Clear the arg now that it is added
-                in_arg = false;
-                arg.clear();
+CommandLineList::MappedFile::~MappedFile()
+{
+    if (data_)
+        munmap(data_, size_);
+}
+
+#endif // defined(WIN32)
+
+namespace
+{
+// Returns the next component of a path starting at pos, skipping empty and "." components, and advances pos past it.
+// Returns an empty string at the end of the path.
+std::string_view nextComponent(std::string_view path, size_t & pos)
+{
+    while (pos < path.size())
+    {
+        size_t const           end       = std::min(path.find('/', pos), path.size());
+        std::string_view const component = path.substr(pos, end - pos);
+        pos = end + 1;
+        if (!component.empty() && component != ".")
+            return component;
+    }
+    return std::string_view();
+}
+} // anonymous namespace
+
+#if !defined(WIN32)
+namespace
+{
+// A wildcard pattern for the entries of a single directory
+struct DirectoryPattern
+{
+    size_t      arg;        // Index of the arg containing the pattern
+    GlobPattern name;       // File name part of the pattern
+};
+
+// A directory whose listing is matched against one or more patterns
+struct Directory
+{
+    std::string_view              path;         // Directory part of the patterns including the final '/', or empty
+    std::vector<DirectoryPattern> patterns;     // Patterns to match against the listing
+    std::vector<std::string>      entries;      // Sorted listing
+};
+
+// Returns the names of the entries in a directory in sorted order, or nothing if it cannot be read
+std::vector<std::string> listDirectory(std::string_view path)
+{
+    std::vector<std::string> entries;
+    DIR * dir = opendir(path.empty() ? "." : std::string(path).c_str());
+    if (dir)
+    {
+        while (dirent const * entry = readdir(dir))
+        {
+            entries.emplace_back(entry->d_name);
+        }
+        closedir(dir);
+    }
+    std::sort(entries.begin(), entries.end());
+    return entries;
+}
+
+// Calls f(i) for each i in [0, n). The calls are spread across the available cores.
+template <typename F>
+void forEachInParallel(size_t n, F f)
+{
+    size_t const nThreads = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), n);
+    if (nThreads <= 1)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            f(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto worker = [&next, n, &f] () {
+        for (size_t i = next++; i < n; i = next++)
+        {
+            f(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+    for (size_t t = 1; t < nThreads; ++t)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto & thread : threads)
+    {
+        thread.join();
+    }
+}
+
+// Returns true if the arg has a "**" component
+bool isRecursive(std::string_view arg)
+{
+    for (size_t i = arg.find("**"); i != std::string_view::npos; i = arg.find("**", i + 1))
+    {
+        if ((i == 0 || arg[i - 1] == '/') && (i + 2 == arg.size() || arg[i + 2] == '/'))
+            return true;
+    }
+    return false;
+}
+
+// Returns true if a directory entry is a directory. A symbolic link is followed.
+bool isDirectory(dirent const * entry, std::string const & path)
+{
+    if (entry->d_type == DT_DIR)
+        return true;
+    if (entry->d_type != DT_LNK && entry->d_type != DT_UNKNOWN)
+        return false;
+    struct stat status;
+    return stat(path.c_str(), &status) == 0 && S_ISDIR(status.st_mode);
+}
+
+// A wildcard pattern split into a base directory without wildcards and the components below it, for walking a tree.
+//
+// A "**" component matches any number of directories (including none). As with "*", a "**" does not match names
+// beginning with '.'. A "**" at the end matches every file and directory below. As with glob(), a pattern ending
+// with '/' only matches directories, and the '/' is kept in the matching paths. The entries "." and ".." can be
+// matched by the last component (by ".*", for example), but they are never read.
+//
+// During a walk, each directory is matched against the set of components that can match its entries. A directory is
+// only read if its set is not empty, so subtrees that cannot contain a match are pruned.
+class PathPattern
+{
+public:
+
+    explicit PathPattern(std::string_view pattern);
+
+    // Returns the leading directories of the pattern including the final '/', or an empty string
+    std::string const & base() const { return base_; }
+
+    // Returns true if the pattern ends with '/' and only matches directories
+    bool directoriesOnly() const { return directoriesOnly_; }
+
+    // Returns the components to match against the entries of the base directory
+    std::vector<size_t> first() const
+    {
+        std::vector<size_t> components;
+        add(components, 0);
+        return components;
+    }
+
+    // Matches an entry of a directory against the components to match in the directory. Returns true if the entry
+    // matches the whole pattern. If the entry must be read, the components to match in it are added to next.
+    // isDirectory() is only called if the type of the entry matters. Both the eager and the lazy expansions match the
+    // entries with this function, so they find the same paths.
+    template <typename IsDirectory>
+    bool match(char const *                name,
+               std::vector<size_t> const & components,
+               IsDirectory                 isDirectory,
+               std::vector<size_t> &       next) const
+    {
+        bool const dots    = name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0));
+        bool       matched = false;
+        int        known   = -1;
+        auto directory = [&] () {
+            if (known < 0)
+                known = isDirectory() ? 1 : 0;
+            return known != 0;
+        };
+
+        for (size_t k : components)
+        {
+            bool const last = (k + 1 == components_.size());
+            if (components_[k].recursive)
+            {
+                if (name[0] == '.')
+                    continue;
+                matched = matched || (last && (!directoriesOnly_ || directory()));
+                if (directory())
+                    add(next, k);
             }
-            else
+            else if (components_[k].pattern.matches(name))
             {
-                arg += c;
+                if (last)
+                    matched = matched || !directoriesOnly_ || directory();
+                else if (!dots && directory())
+                    add(next, k + 1);
             }
         }
+        return matched;
+    }
 
-        // Otherwise, if we aren't in an arg, then skip white space until the next arg is found
+private:
 
-        else
+    // A component of the pattern
+    struct Component
+    {
+        bool        recursive;  // True if the component is "**"
+        GlobPattern pattern;
+    };
+
+    // Adds component k to a set of components to match. Since a "**" can match no directories, the component following
+    // it is added too.
+    void add(std::vector<size_t> & components, size_t k) const;
+
+    std::string            base_;               // Leading part of the pattern without wildcards, or empty
+    std::vector<Component> components_;         // Remaining components of the pattern
+    bool                   directoriesOnly_;    // True if the pattern ends with '/'
+};
+
+PathPattern::PathPattern(std::string_view pattern)
+    : directoriesOnly_(!pattern.empty() && pattern.back() == '/')
+{
+    // The base is the directory part leading up to the first component with wildcards or escapes
+    size_t start = 0;
+    for (size_t slash = pattern.find('/'); slash != std::string_view::npos; slash = pattern.find('/', start))
+    {
+        if (pattern.substr(start, slash - start).find_first_of("*?[\\") != std::string_view::npos)
+            break;
+        start = slash + 1;
+    }
+    base_ = pattern.substr(0, start);
+
+    while (start < pattern.size())
+    {
+        size_t const end = std::min(pattern.find('/', start), pattern.size());
+        if (end > start)
         {
-            // If a new arg is found, set everything up for the next arg
+            std::string_view const component = pattern.substr(start, end - start);
+            components_.push_back(Component { component == "**", GlobPattern(component) });
+        }
+        start = end + 1;
+    }
+}
 
-            if (!isspace(c))
-            {
-                in_arg        = true;
-                in_quoted_arg = (c == '"');
+void PathPattern::add(std::vector<size_t> & components, size_t k) const
+{
+    for (; k < components_.size(); ++k)
+    {
+        auto const i = std::lower_bound(components.begin(), components.end(), k);
+        if (i == components.end() || *i != k)
+            components.insert(i, k);
+        if (!components_[k].recursive)
+            break;
+    }
+}
 
-                // Save the first char if it isn't a quote
-                if (!in_quoted_arg)
-                    arg += c;
-            }
+// Expands patterns with "**" components.
+//
+// The trees are walked by a single pool of threads sharing a stack of directories to read, no matter how many patterns
+// there are. Each directory is read once per pattern, and only if some part of the pattern can match below it. A
+// directory that is its own ancestor (through a symbolic link) is skipped.
+class RecursiveGlob
+{
+public:
+
+    explicit RecursiveGlob(std::vector<std::string_view> const & patterns)
+        : patterns_(patterns.begin(), patterns.end()), matches_(patterns.size())
+    {
+    }
+
+    // Returns the matching paths of each pattern in sorted order
+    std::vector<std::vector<std::string>> expand();
+
+private:
+
+    // A directory on the path from the start of the walk, used to detect loops
+    struct Ancestor
+    {
+        dev_t                           device;
+        ino_t                           inode;
+        std::shared_ptr<Ancestor const> parent;
+    };
+
+    // A directory to read, and the components of the pattern to match against its entries
+    struct Work
+    {
+        size_t                          pattern;        // Index of the pattern
+        std::string                     path;           // Path of the directory including the final '/', or empty
+        std::vector<size_t>             components;     // Indexes of the components to match (sorted)
+        std::shared_ptr<Ancestor const> ancestors;      // Directories above this one
+    };
+
+    // A matching path, and the index of the pattern it matches
+    using Match = std::pair<size_t, std::string>;
+
+    // Reads a directory and returns its matching entries and the subdirectories to read
+    void read(Work const & work, std::vector<Match> & matches, std::vector<Work> & subdirectories) const;
+
+    // Reads directories until there are none left
+    void walk();
+
+    std::vector<PathPattern>              patterns_;
+    std::mutex                            mutex_;
+    std::condition_variable               ready_;       // Signaled when work is added or the walk is done
+    std::vector<Work>                     stack_;       // Directories waiting to be read
+    size_t                                busy_ = 0;    // Number of directories being read
+    std::vector<std::vector<std::string>> matches_;     // Matching paths of each pattern
+};
+
+std::vector<std::vector<std::string>> RecursiveGlob::expand()
+{
+    if (patterns_.empty())
+        return {};
+
+    for (size_t i = 0; i < patterns_.size(); ++i)
+    {
+        stack_.push_back(Work { i, patterns_[i].base(), patterns_[i].first(), nullptr });
+    }
+
+    unsigned const           nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+    for (unsigned t = 1; t < nThreads; ++t)
+    {
+        threads.emplace_back(&RecursiveGlob::walk, this);
+    }
+    walk();
+    for (auto & thread : threads)
+    {
+        thread.join();
+    }
+
+    // A path can be reached in more than one way if the pattern has more than one "**"
+    for (auto & matches : matches_)
+    {
+        std::sort(matches.begin(), matches.end());
+        matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+    }
+    return std::move(matches_);
+}
+
+void RecursiveGlob::read(Work const & work, std::vector<Match> & matches, std::vector<Work> & subdirectories) const
+{
+    PathPattern const & pattern = patterns_[work.pattern];
+
+    DIR * dir = opendir(work.path.empty() ? "." : work.path.c_str());
+    if (!dir)
+        return;
+
+    struct stat status;
+    if (fstat(dirfd(dir), &status) != 0)
+    {
+        closedir(dir);
+        return;
+    }
+    for (Ancestor const * a = work.ancestors.get(); a; a = a->parent.get())
+    {
+        if (a->device == status.st_dev && a->inode == status.st_ino)
+        {
+            closedir(dir);
+            return;
         }
     }
+    auto const self = std::make_shared<Ancestor const>(Ancestor { status.st_dev, status.st_ino, work.ancestors });
 
-    // If the end of the string was reached while processing an arg, then 'arg' will contain the arg being processed. It must be
-    // added to the list now.
+    while (dirent const * entry = readdir(dir))
+    {
+        char const * const  name = entry->d_name;
+        std::string         path = work.path + name;
+        std::vector<size_t> next;
+        auto                directory = [entry, &path] () { return isDirectory(entry, path); };
+        bool const          matched   = pattern.match(name, work.components, directory, next);
 
-    if (arg.size() > 0)
-        include(arg.c_str());
+        if (matched)
+            matches.emplace_back(work.pattern, pattern.directoriesOnly() ? path + '/' : path);
+        if (!next.empty())
+            subdirectories.push_back(Work { work.pattern, std::move(path) + '/', std::move(next), self });
+    }
+    closedir(dir);
 }
 
-CommandLineList::CommandLineList(int argc, char ** argv)
+void RecursiveGlob::walk()
 {
+    std::vector<Match> matches;
+    std::vector<Work>  subdirectories;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        ready_.wait(lock, [this] () { return !stack_.empty() || busy_ == 0; });
+        if (stack_.empty())
+            break;
+
+        Work work = std::move(stack_.back());
+        stack_.pop_back();
+        ++busy_;
+        lock.unlock();
+
+        read(work, matches, subdirectories);
+
+        lock.lock();
+        --busy_;
+        bool const notify = !subdirectories.empty() || (busy_ == 0 && stack_.empty());
+        std::move(subdirectories.begin(), subdirectories.end(), std::back_inserter(stack_));
+        subdirectories.clear();
+        if (notify)
+            ready_.notify_all();
+    }
+    for (auto & match : matches)
+    {
+        matches_[match.first].push_back(std::move(match.second));
+    }
+}
+} // anonymous namespace
+#endif // !defined(WIN32)
+
+CommandLineList::CommandLineList(char const * commandLine, bool expandWildcards)
+{
+    // The command line is copied into the arena once, and the args are terminated in place. No token is longer than
+    // the command line, so the copy is the only allocation unless wildcards are expanded.
+
+    size_t const length = strlen(commandLine);
+    reserve(length + 1);
+    char * const buffer = allocate(length + 1);
+    memcpy(buffer, commandLine, length + 1);
+
+    std::vector<std::string_view> tokens;
+    tokenize(buffer, buffer + length, tokens);
+    expand(tokens, expandWildcards);
+}
+
+CommandLineList::CommandLineList(int argc, char ** argv, bool expandWildcards)
+{
+    // Reserve space for all of the args with a single allocation
+
+    size_t total = 0;
+    for (int i = 0; i < argc; ++i)
+    {
+        total += strlen(argv[i]) + 1;
+    }
+    reserve(total);
+
     // Extract command
 
-    args_.push_back(*argv);
+    args_.push_back(store(*argv));
     ++argv;
     --argc;
 
     // Parse the rest of the command line
 
+    std::vector<std::string_view> tokens;
+    tokens.reserve(argc);
     while (argc > 0)
     {
-        include(*argv);
+        tokens.push_back(store(*argv));
         ++argv;
         --argc;
     }
+    expand(tokens, expandWildcards);
+}
+
+CommandLineList::CommandLineList(CommandLineList const & rhs)
+{
+    size_t total = 0;
+    for (auto const & arg : rhs.args_)
+    {
+        total += arg.size() + 1;
+    }
+    reserve(total);
+
+    args_.reserve(rhs.args_.size());
+    for (auto const & arg : rhs.args_)
+    {
+        args_.push_back(store(arg));
+    }
+}
+
+CommandLineList::CommandLineList(CommandLineList && rhs) noexcept
+    : files_(std::move(rhs.files_))
+    , blocks_(std::move(rhs.blocks_))
+    , next_(rhs.next_)
+    , available_(rhs.available_)
+    , args_(std::move(rhs.args_))
+{
+    rhs.files_.clear();
+    rhs.blocks_.clear();
+    rhs.next_      = nullptr;
+    rhs.available_ = 0;
+    rhs.args_.clear();
+}
+
+CommandLineList::~CommandLineList() = default;
+
+CommandLineList & CommandLineList::operator =(CommandLineList rhs)
+{
+    std::swap(files_, rhs.files_);
+    std::swap(blocks_, rhs.blocks_);
+    std::swap(next_, rhs.next_);
+    std::swap(available_, rhs.available_);
+    std::swap(args_, rhs.args_);
+    return *this;
 }
 
 void CommandLineList::include(char const * arg)
 {
+    expand(std::vector<std::string_view> { store(arg) });
+}
+
+void CommandLineList::include(std::vector<std::string_view> const & args)
+{
+    std::vector<std::string_view> tokens;
+    tokens.reserve(args.size());
+    for (auto const & arg : args)
+    {
+        tokens.push_back(store(arg));
+    }
+    expand(tokens);
+}
+
+void CommandLineList::removeDuplicates(bool sort)
+{
+    size_t const n = args_.size();
+    assert(n < UINT32_MAX);
+
+    // The table has at least 1.5 slots per arg. A slot holds the index of an arg plus one (0 is empty) and its hash.
+    size_t capacity = 16;
+    while (capacity < n + n / 2)
+    {
+        capacity *= 2;
+    }
+    size_t const                               mask = capacity - 1;
+    std::vector<std::pair<uint32_t, uint32_t>> table(capacity, { 0, 0 });
+
+    // Each arg that is not already in the table is moved down to its final position and added to the table
+    size_t kept = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        std::string_view const arg  = args_[i];
+        uint32_t const         hash = pathHash(arg);
+        size_t                 slot = hash & mask;
+        bool                   found = false;
+        for (; table[slot].first != 0; slot = (slot + 1) & mask)
+        {
+            if (table[slot].second == hash && pathEqual(args_[table[slot].first - 1], arg))
+            {
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+        {
+            args_[kept] = arg;
+            table[slot] = { static_cast<uint32_t>(kept + 1), hash };
+            ++kept;
+        }
+    }
+    args_.resize(kept);
+
+    if (sort)
+        std::sort(args_.begin(), args_.end());
+}
+
+uint32_t CommandLineList::pathHash(std::string_view path)
+{
+    // FNV-1a over the components, each followed by a separator
+    uint32_t hash = (!path.empty() && path[0] == '/') ? 0x811c9dc5u ^ '/' : 0x811c9dc5u;
+    size_t   pos  = 0;
+    for (std::string_view c = nextComponent(path, pos); !c.empty(); c = nextComponent(path, pos))
+    {
+        for (char x : c)
+        {
+            hash = (hash ^ static_cast<unsigned char>(x)) * 16777619u;
+        }
+        hash = (hash ^ '/') * 16777619u;
+    }
+    return hash;
+}
+
+bool CommandLineList::pathEqual(std::string_view a, std::string_view b)
+{
+    if (a == b)
+        return true;
+    if ((!a.empty() && a[0] == '/') != (!b.empty() && b[0] == '/'))
+        return false;
+
+    size_t aPos = 0;
+    size_t bPos = 0;
+    for (;;)
+    {
+        std::string_view const aComponent = nextComponent(a, aPos);
+        std::string_view const bComponent = nextComponent(b, bPos);
+        if (aComponent != bComponent)
+            return false;
+        if (aComponent.empty())
+            return true;
+    }
+}
+
+void CommandLineList::tokenize(char * begin, char * end, std::vector<std::string_view> & tokens)
+{
+    bool   in_arg        = false;      // true if processing an arg
+    bool   in_quoted_arg = false;      // true if the current arg is quoted
+    char * arg           = nullptr;    // start of the current arg
+
+    // Scan the text for args and add them to the list. Whitespace is ignored inside quoted args.
+
+    for (char * p = begin; p < end; p++)
+    {
+        char const c = *p;
+
+        // Continue until white space (or a double quote for quoted args) is found. When the end of the arg is found,
+        // terminate it and add it to the list
+        if (in_arg)
+        {
+            if ((!in_quoted_arg && isspace(static_cast<unsigned char>(c))) || (in_quoted_arg && c == '"'))
+            {
+                *p = 0;
+                tokens.emplace_back(arg, p - arg);
+                in_arg = false;
+            }
+        }
+
+        // Otherwise, if we aren't in an arg, then skip white space until the next arg is found
+
+        else
+        {
+            // If a new arg is found, set everything up for the next arg. The opening quote is not part of the arg.
+
+            if (!isspace(static_cast<unsigned char>(c)))
+            {
+                in_arg        = true;
+                in_quoted_arg = (c == '"');
+                arg           = in_quoted_arg ? p + 1 : p;
+            }
+        }
+    }
+
+    // If the end of the text was reached while processing an arg, then it must be added to the list now. It is not
+    // terminated unless the text is.
+
+    if (in_arg && arg != end)
+        tokens.emplace_back(arg, end - arg);
+}
+
+void CommandLineList::reserve(size_t size)
+{
+    blocks_.emplace_back(new char[size]);
+    next_      = blocks_.back().get();
+    available_ = size;
+}
+
+char * CommandLineList::allocate(size_t size)
+{
+    if (size > available_)
+        reserve(std::max(size, BLOCK_SIZE));
+
+    char * p = next_;
+    next_      += size;
+    available_ -= size;
+    return p;
+}
+
+std::string_view CommandLineList::store(std::string_view s)
+{
+    char * const p = allocate(s.size() + 1);
+    memcpy(p, s.data(), s.size());
+    p[s.size()] = 0;
+    return std::string_view(p, s.size());
+}
+
+void CommandLineList::readResponseFiles(std::vector<std::string_view> const & args,
+                                        std::vector<std::string_view> &       tokens,
+                                        std::vector<FileId> &                 open)
+{
+    for (auto const & arg : args)
+    {
+        if (arg.size() < 2 || arg[0] != '@')
+        {
+            tokens.push_back(arg);
+            continue;
+        }
+
+        // A file that cannot be read, or that is already being read (directly or indirectly), is not a response file
+        auto file = std::make_unique<MappedFile>(arg.data() + 1);
+        if (!file->valid() || std::find(open.begin(), open.end(), file->id()) != open.end())
+        {
+            tokens.push_back(arg);
+            continue;
+        }
+
+        // The tokens are terminated in the mapping, except for one that runs to the end of the file, which is copied
+        std::vector<std::string_view> contents;
+        tokenize(file->data(), file->data() + file->size(), contents);
+        if (!contents.empty() && contents.back().data() + contents.back().size() == file->data() + file->size())
+            contents.back() = store(contents.back());
+
+        open.push_back(file->id());
+        files_.push_back(std::move(file));
+        readResponseFiles(contents, tokens, open);
+        open.pop_back();
+    }
+}
+
+void CommandLineList::expand(std::vector<std::string_view> const & unexpanded, bool expandWildcards)
+{
+    // Note: the args are terminated
+
+    std::vector<std::string_view> args;
+    std::vector<FileId>           open;
+    readResponseFiles(unexpanded, args, open);
+
+    if (!expandWildcards)
+    {
+        args_.insert(args_.end(), args.begin(), args.end());
+        return;
+    }
+
+#if defined(WIN32)
+    for (auto const & arg : args)
+    {
+        expand(arg);
+    }
+#else
+    // Patterns with wildcards only in the file name are grouped by directory so that each directory is read once, no
+    // matter how many patterns refer to it. Patterns with "**" are expanded by a recursive walk. Anything else is left
+    // to glob().
+
+    std::vector<Directory>                       directories;
+    std::unordered_map<std::string_view, size_t> indexes;      // Index of each directory by path
+    std::vector<size_t>                          directoryOf(args.size(), SIZE_MAX);   // Directory of each grouped arg
+    std::vector<size_t>                          expansionOf(args.size(), SIZE_MAX);   // Expansion of each "**" arg
+    std::vector<std::string_view>                recursive;                            // Args with "**"
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        std::string_view const arg   = args[i];
+        if (isRecursive(arg))
+        {
+            expansionOf[i] = recursive.size();
+            recursive.push_back(arg);
+            continue;
+        }
+
+        size_t const           slash = arg.rfind('/');
+        std::string_view const path  = (slash == std::string_view::npos) ? std::string_view() : arg.substr(0, slash + 1);
+        std::string_view const name  = arg.substr(path.size());
+        bool const             grouped = GlobPattern::hasWildcards(name) &&
+                                         path.find_first_of("*?[\\") == std::string_view::npos;
+        if (!grouped)
+            continue;
+
+        auto const d = indexes.emplace(path, directories.size());
+        if (d.second)
+            directories.push_back(Directory { path, {}, {} });
+        directories[d.first->second].patterns.push_back({ i, GlobPattern(name) });
+        directoryOf[i] = d.first->second;
+    }
+
+    // Read and match the directories in parallel. Each directory only writes the matches of its own patterns, and the
+    // listings are sorted, so the results are the same as glob() would return, regardless of the scheduling.
+
+    std::vector<std::vector<size_t>> matches(args.size());  // Indexes of the matching directory entries of each arg
+    forEachInParallel(directories.size(), [&directories, &matches] (size_t d) {
+        Directory & directory = directories[d];
+        directory.entries = listDirectory(directory.path);
+        for (auto const & pattern : directory.patterns)
+        {
+            for (size_t e = 0; e < directory.entries.size(); ++e)
+            {
+                if (pattern.name.matches(directory.entries[e]))
+                    matches[pattern.arg].push_back(e);
+            }
+        }
+    });
+
+    // All of the recursive args are walked by a single pool of threads
+    std::vector<std::vector<std::string>> const expansions = RecursiveGlob(recursive).expand();
+
+    // Add the results in the order of the args. As with GLOB_NOCHECK, a pattern that matches nothing is added as is.
+
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        if (expansionOf[i] != SIZE_MAX)
+        {
+            std::vector<std::string> const & expansion = expansions[expansionOf[i]];
+            if (expansion.empty())
+                args_.push_back(args[i]);
+            for (auto const & path : expansion)
+            {
+                args_.push_back(store(path));
+            }
+        }
+        else if (directoryOf[i] == SIZE_MAX)
+        {
+            expand(args[i]);
+        }
+        else if (matches[i].empty())
+        {
+            args_.push_back(args[i]);
+        }
+        else
+        {
+            Directory const & directory = directories[directoryOf[i]];
+            for (size_t e : matches[i])
+            {
+                std::string const & entry = directory.entries[e];
+                size_t const        size  = directory.path.size() + entry.size();
+                char * const        p     = allocate(size + 1);
+                memcpy(p, directory.path.data(), directory.path.size());
+                memcpy(p + directory.path.size(), entry.c_str(), entry.size() + 1);
+                args_.emplace_back(p, size);
+            }
+        }
+    }
+#endif
+}
+
+void CommandLineList::expand(std::string_view arg)
+{
+    // Note: arg is terminated
+
 #if defined(WIN32)
     // Validate the length of the arg. FindFirstFile cannot handle strings
     // longer than MAX_PATH. If the string is too long then add it as is.
 
-    if (strlen(arg) >= MAX_PATH)
+    if (arg.size() >= MAX_PATH)
     {
         args_.push_back(arg);
         return;
@@ -96,20 +941,19 @@ void CommandLineList::include(char const * arg)
     // Check if the arg has any wildcards. If it does, then search for files.
     // Otherwise just add it as is.
 
-    if (strpbrk(arg, "*?") != NULL)
+    if (strpbrk(arg.data(), "*?") != NULL)
     {
         // Get the directory path because the find file function return only
         // file names.
 
         char drive[_MAX_DRIVE], dir[_MAX_DIR];
-        _splitpath(arg, drive, dir, NULL, NULL);
+        _splitpath(arg.data(), drive, dir, NULL, NULL);
 
         // Set up the find file stuff and get the first file
 
-        int count = 0;
         WIN32_FIND_DATA find_data;
 
-        HANDLE handle = FindFirstFile(arg, &find_data);
+        HANDLE handle = FindFirstFile(arg.data(), &find_data);
 
         // If a file is found, repeatedly add the found file to the list and find
         // another until there are no more.
@@ -123,7 +967,7 @@ void CommandLineList::include(char const * arg)
                 char path_buffer[_MAX_PATH];
 
                 _makepath(path_buffer, drive, dir, find_data.cFileName, NULL);
-                args_.push_back(path_buffer);
+                args_.push_back(store(path_buffer));
             } while (FindNextFile(handle, &find_data) != FALSE);
         }
 
@@ -134,21 +978,22 @@ void CommandLineList::include(char const * arg)
         args_.push_back(arg);
     }
 #else
-    if (strpbrk(arg, "*?["))
+    if (strpbrk(arg.data(), "*?["))
     {
+        // With GLOB_NOCHECK, the pattern itself is returned if nothing matches it
         glob_t buffer;
-        if (glob(arg, GLOB_NOCHECK, nullptr, &buffer))
+        if (glob(arg.data(), GLOB_NOCHECK, nullptr, &buffer) == 0)
         {
             for (char ** p = buffer.gl_pathv; *p; ++p)
             {
-                args_.push_back(*p);
+                args_.push_back(store(*p));
             }
-            globfree(&buffer);
         }
         else
         {
             args_.push_back(arg);
         }
+        globfree(&buffer);
     }
     else
     {
@@ -156,3 +1001,189 @@ void CommandLineList::include(char const * arg)
     }
 #endif
 }
+
+// The state of a lazy expansion. On POSIX systems, the directories being read are kept on an explicit stack, so only
+// one directory per level is open at a time and nothing is read until it is needed. On Windows, each arg is expanded
+// as a whole when it is reached.
+class CommandLineList::ExpandingIterator::Walker
+{
+public:
+
+    explicit Walker(CommandLineList const & list) : list_(list) {}
+    ~Walker();
+
+    // Finds the next arg or path. Returns false if there are none left.
+    bool next(std::string_view & arg);
+
+private:
+
+    // non-copyable
+    Walker(Walker const &) = delete;
+    Walker & operator =(Walker const &) = delete;
+
+#if defined(WIN32)
+    std::unique_ptr<CommandLineList> expanded_;     // Expansion of the current arg
+    size_t                           position_ = 0; // Next path in the expansion
+#else
+    // A directory being read
+    struct Frame
+    {
+        DIR *               dir;
+        std::string         path;           // Path of the directory including the final '/', or empty
+        std::vector<size_t> components;     // Indexes of the components to match (sorted)
+        dev_t               device;
+        ino_t               inode;
+    };
+
+    // Opens a directory and pushes it on the stack, unless it is already on the stack (through a symbolic link)
+    void push(std::string path, std::vector<size_t> components);
+
+    // Finds the next path matching the current pattern. Returns false if there are none left.
+    bool step(std::string_view & path);
+
+    std::unique_ptr<PathPattern> pattern_;          // Pattern being expanded, or null
+    std::vector<Frame>           stack_;            // Directories being read
+    std::string                  path_;             // Current path
+    bool                         matched_ = false;  // True if the pattern has matched a path
+#endif
+    CommandLineList const & list_;
+    size_t                  index_ = 0;             // Index of the current arg
+};
+
+CommandLineList::ExpandingIterator::Walker::~Walker()
+{
+#if !defined(WIN32)
+    for (auto & frame : stack_)
+    {
+        closedir(frame.dir);
+    }
+#endif
+}
+
+bool CommandLineList::ExpandingIterator::Walker::next(std::string_view & arg)
+{
+    for (;;)
+    {
+#if defined(WIN32)
+        if (expanded_)
+        {
+            if (position_ < expanded_->args_.size())
+            {
+                arg = expanded_->args_[position_++];
+                return true;
+            }
+            expanded_.reset();
+            ++index_;
+            continue;
+        }
+#else
+        if (pattern_)
+        {
+            if (step(arg))
+                return true;
+
+            // As in the constructors, a pattern that matches nothing is added as is
+            pattern_.reset();
+            if (!matched_)
+            {
+                arg = list_.args_[index_++];
+                return true;
+            }
+            ++index_;
+            continue;
+        }
+#endif
+
+        if (index_ == list_.args_.size())
+            return false;
+
+        std::string_view const token = list_.args_[index_];
+        if (!GlobPattern::hasWildcards(token))
+        {
+            arg = token;
+            ++index_;
+            return true;
+        }
+
+#if defined(WIN32)
+        expanded_ = std::make_unique<CommandLineList>("");
+        expanded_->expand(expanded_->store(token));
+        position_ = 0;
+#else
+        pattern_ = std::make_unique<PathPattern>(token);
+        matched_ = false;
+        push(pattern_->base(), pattern_->first());
+#endif
+    }
+}
+
+#if !defined(WIN32)
+
+void CommandLineList::ExpandingIterator::Walker::push(std::string path, std::vector<size_t> components)
+{
+    DIR * dir = opendir(path.empty() ? "." : path.c_str());
+    if (!dir)
+        return;
+
+    struct stat status;
+    bool const  loop = fstat(dirfd(dir), &status) != 0 ||
+                       std::any_of(stack_.begin(), stack_.end(), [&status] (Frame const & frame) {
+                           return frame.device == status.st_dev && frame.inode == status.st_ino;
+                       });
+    if (loop)
+    {
+        closedir(dir);
+        return;
+    }
+    stack_.push_back(Frame { dir, std::move(path), std::move(components), status.st_dev, status.st_ino });
+}
+
+bool CommandLineList::ExpandingIterator::Walker::step(std::string_view & path)
+{
+    std::vector<size_t> next;
+    while (!stack_.empty())
+    {
+        Frame &        frame = stack_.back();
+        dirent const * entry = readdir(frame.dir);
+        if (!entry)
+        {
+            closedir(frame.dir);
+            stack_.pop_back();
+            continue;
+        }
+
+        char const * const name = entry->d_name;
+        path_.assign(frame.path).append(name);
+        next.clear();
+        auto       directory = [entry, this] () { return isDirectory(entry, path_); };
+        bool const matched   = pattern_->match(name, frame.components, directory, next);
+
+        // Note: frame is invalid after the push
+        if (!next.empty())
+            push(path_ + '/', std::move(next));
+        if (matched)
+        {
+            matched_ = true;
+            if (pattern_->directoriesOnly())
+                path_ += '/';
+            path     = path_;
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif // !defined(WIN32)
+
+CommandLineList::ExpandingIterator::ExpandingIterator(CommandLineList const & list)
+    : walker_(std::make_shared<Walker>(list))
+{
+    ++*this;
+}
+
+CommandLineList::ExpandingIterator & CommandLineList::ExpandingIterator::operator ++()
+{
+    if (!walker_->next(current_))
+        walker_.reset();
+    return *this;
+}
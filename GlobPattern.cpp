@@ -0,0 +1,294 @@
+#include "GlobPattern.h"
+
+#include <algorithm>
+#include <cstring>
+
+//! @param  pattern     Wildcard pattern. Components are separated by '/'.
+GlobPattern::GlobPattern(std::string_view pattern)
+    : literal_(true)
+{
+    // Compile each component into a list of elements
+
+    size_t start = 0;
+    for (;;)
+    {
+        size_t const           end  = std::min(pattern.find('/', start), pattern.size());
+        std::string_view const text = pattern.substr(start, end - start);
+        uint32_t const         first = static_cast<uint32_t>(elements_.size());
+
+        if (text == "**")
+        {
+            components_.push_back({ first, first, true });
+            literal_ = false;
+        }
+        else
+        {
+            // Appends a character to the literal element at the end of the component, or starts a new one
+            auto appendLiteral = [this, first] (char c) {
+                if (elements_.size() > first && elements_.back().op == Element::LITERAL)
+                {
+                    ++elements_.back().size;
+                }
+                else
+                {
+                    elements_.push_back({ Element::LITERAL, static_cast<uint32_t>(literals_.size()), 1 });
+                }
+                literals_ += c;
+            };
+
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                char const c = text[i];
+                if (c == '\\' && i + 1 < text.size())
+                {
+                    appendLiteral(text[++i]);
+                }
+                else if (c == '*')
+                {
+                    // Consecutive stars are the same as one
+                    if (elements_.size() == first || elements_.back().op != Element::STAR)
+                        elements_.push_back({ Element::STAR, 0, 0 });
+                    literal_ = false;
+                }
+                else if (c == '?')
+                {
+                    elements_.push_back({ Element::ANY, 0, 0 });
+                    literal_ = false;
+                }
+                else if (c == '[')
+                {
+                    // A ']' immediately after the '[' (or the negation) is part of the set. If the set is not closed,
+                    // the '[' is an ordinary character.
+                    std::bitset<256> set;
+                    size_t           j      = i + 1;
+                    bool const       negate = j < text.size() && (text[j] == '!' || text[j] == '^');
+                    if (negate)
+                        ++j;
+                    size_t const begin = j;
+                    for (size_t k = begin; k < text.size() && (text[k] != ']' || k == begin); ++k)
+                    {
+                        unsigned char from = static_cast<unsigned char>(text[k]);
+                        if (from == '\\' && k + 1 < text.size())
+                            from = static_cast<unsigned char>(text[++k]);
+                        unsigned char to = from;
+                        if (k + 2 < text.size() && text[k + 1] == '-' && text[k + 2] != ']')
+                        {
+                            k += 2;
+                            to = static_cast<unsigned char>(text[k]);
+                        }
+                        for (unsigned x = from; x <= to; ++x)
+                        {
+                            set.set(x);
+                        }
+                        j = k + 1;
+                    }
+
+                    if (j < text.size() && text[j] == ']')
+                    {
+                        if (negate)
+                            set.flip();
+                        set.reset('/');
+                        elements_.push_back({ Element::SET, static_cast<uint32_t>(sets_.size()), 0 });
+                        sets_.push_back(set);
+                        literal_ = false;
+                        i        = j;
+                    }
+                    else
+                    {
+                        appendLiteral(c);
+                    }
+                }
+                else
+                {
+                    appendLiteral(c);
+                }
+            }
+            components_.push_back({ first, static_cast<uint32_t>(elements_.size()), false });
+        }
+
+        if (end == pattern.size())
+            break;
+        start = end + 1;
+    }
+
+    // A trailing "**" matches at least one component below its directory, so it is the same as "**/*"
+    if (components_.back().recursive)
+    {
+        uint32_t const first = static_cast<uint32_t>(elements_.size());
+        elements_.push_back({ Element::STAR, 0, 0 });
+        components_.push_back({ first, first + 1, false });
+    }
+
+    // Find the literal prefix, which ends at the first wildcard
+
+    for (size_t c = 0; c < components_.size(); ++c)
+    {
+        Component const & component = components_[c];
+        if (component.recursive)
+            break;
+
+        uint32_t i = component.first;
+        for (; i < component.last && elements_[i].op == Element::LITERAL; ++i)
+        {
+            prefix_.append(literals_, elements_[i].offset, elements_[i].size);
+        }
+        if (i < component.last || c + 1 == components_.size())
+            break;
+        prefix_ += '/';
+    }
+
+    // Find the literal suffix of the last component
+
+    Component const & last = components_.back();
+    if (!literal_ && last.last > last.first && elements_[last.last - 1].op == Element::LITERAL)
+    {
+        Element const & element = elements_[last.last - 1];
+        suffix_.assign(literals_, element.offset, element.size);
+    }
+}
+
+//! @param  path    Path to match. Components are separated by '/'.
+bool GlobPattern::matches(std::string_view path) const
+{
+    if (literal_)
+        return path == prefix_;
+
+    // Reject paths that do not have the literal prefix and suffix before doing any matching
+    if (path.size() < prefix_.size() + suffix_.size() ||
+        path.compare(0, prefix_.size(), prefix_) != 0 ||
+        path.compare(path.size() - suffix_.size(), suffix_.size(), suffix_) != 0)
+    {
+        return false;
+    }
+
+    // The components are matched in order. When a component does not match, the most recent "**" takes one more
+    // component of the path and matching resumes after it. Since every other component matches exactly one component
+    // of the path, backtracking to only the most recent "**" is sufficient. A position past the end of the path means
+    // that all of its components have been matched.
+
+    char const * const s = path.data();
+    size_t const       n = path.size();
+
+    size_t i       = 0;           // Next component of the pattern
+    size_t pos     = 0;           // Start of the next component of the path
+    size_t starI   = SIZE_MAX;    // Component following the most recent "**"
+    size_t starPos = 0;           // Start of the path component following the ones taken by the most recent "**"
+    for (;;)
+    {
+        if (i < components_.size())
+        {
+            Component const & component = components_[i];
+            if (component.recursive)
+            {
+                starI   = ++i;
+                starPos = pos;
+                continue;
+            }
+            if (pos <= n)
+            {
+                char const * const slash = static_cast<char const *>(memchr(s + pos, '/', n - pos));
+                size_t const       end   = slash ? slash - s : n;
+                if (matches(component, s + pos, s + end))
+                {
+                    pos = end + 1;
+                    ++i;
+                    continue;
+                }
+            }
+        }
+        else if (pos == n + 1)
+        {
+            return true;
+        }
+
+        // The "**" takes the next component, which must exist and must not be hidden
+        if (starI == SIZE_MAX || starPos > n || (starPos < n && s[starPos] == '.'))
+            return false;
+        char const * const slash = static_cast<char const *>(memchr(s + starPos, '/', n - starPos));
+        starPos = (slash ? slash - s : n) + 1;
+        pos     = starPos;
+        i       = starI;
+    }
+}
+
+//! @param  s   String to check
+bool GlobPattern::hasWildcards(std::string_view s)
+{
+    return s.find_first_of("*?[") != std::string_view::npos;
+}
+
+bool GlobPattern::matches(Component const & component, char const * begin, char const * end) const
+{
+    uint32_t const last = component.last;
+
+    // A leading '.' must be matched by a literal
+    if (begin < end && *begin == '.' && (component.first == last || elements_[component.first].op != Element::LITERAL))
+        return false;
+
+    // The elements are matched in order. When an element does not match, the most recent '*' takes one more
+    // character and matching resumes after it. If the element following the '*' is a literal, the '*' skips directly
+    // to the next occurrence of its first character.
+
+    char const * p     = begin;
+    uint32_t     i     = component.first;
+    uint32_t     starI = 0;          // Element following the most recent '*'
+    char const * starP = nullptr;    // Character following the ones taken by the most recent '*'
+    for (;;)
+    {
+        if (i < last)
+        {
+            Element const & element = elements_[i];
+            if (element.op == Element::STAR)
+            {
+                // A trailing '*' matches the rest of the component
+                if (++i == last)
+                    return true;
+                starI = i;
+                starP = p;
+                continue;
+            }
+            if (p < end)
+            {
+                if (element.op == Element::ANY)
+                {
+                    ++p;
+                    ++i;
+                    continue;
+                }
+                if (element.op == Element::SET)
+                {
+                    if (sets_[element.offset][static_cast<unsigned char>(*p)])
+                    {
+                        ++p;
+                        ++i;
+                        continue;
+                    }
+                }
+                else if (static_cast<size_t>(end - p) >= element.size &&
+                         memcmp(p, literals_.data() + element.offset, element.size) == 0)
+                {
+                    p += element.size;
+                    ++i;
+                    continue;
+                }
+            }
+        }
+        else if (p == end)
+        {
+            return true;
+        }
+
+        if (!starP || starP == end)
+            return false;
+        ++starP;
+        Element const & next = elements_[starI];
+        if (next.op == Element::LITERAL)
+        {
+            starP = static_cast<char const *>(memchr(starP, literals_[next.offset], end - starP));
+            if (!starP)
+                return false;
+        }
+        p = starP;
+        i = starI;
+    }
+}
@@ -0,0 +1,820 @@
+#include "PathName.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#if defined(__AVX2__)
+#define MISC_PATHNAME_AVX2
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MISC_PATHNAME_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+#if defined(MISC_PATHNAME_SSE2)
+// Folds 16 characters at once, as char_traits_path_char::fold() does
+__m128i fold16(__m128i x)
+{
+    // x + (0x80 - 'a') is less than 0x80 + 26 as a signed byte only if x is in 'a' - 'z'
+    __m128i const lower     = _mm_cmplt_epi8(_mm_add_epi8(x, _mm_set1_epi8(static_cast<char>(0x80 - 'a'))),
+                                             _mm_set1_epi8(static_cast<char>(0x80 + 26)));
+    __m128i const backslash = _mm_cmpeq_epi8(x, _mm_set1_epi8('\\'));
+    x = _mm_sub_epi8(x, _mm_and_si128(lower, _mm_set1_epi8('a' - 'A')));
+    return _mm_xor_si128(x, _mm_and_si128(backslash, _mm_set1_epi8('\\' ^ '/')));
+}
+#endif // defined(MISC_PATHNAME_SSE2)
+
+#if defined(MISC_PATHNAME_AVX2)
+// Folds 32 characters at once, as char_traits_path_char::fold() does
+__m256i fold32(__m256i x)
+{
+    __m256i const lower     = _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(0x80 + 26)),
+                                                _mm256_add_epi8(x, _mm256_set1_epi8(static_cast<char>(0x80 - 'a'))));
+    __m256i const backslash = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\\'));
+    x = _mm256_sub_epi8(x, _mm256_and_si256(lower, _mm256_set1_epi8('a' - 'A')));
+    return _mm256_xor_si256(x, _mm256_and_si256(backslash, _mm256_set1_epi8('\\' ^ '/')));
+}
+#endif // defined(MISC_PATHNAME_AVX2)
+
+// Mixes a word of folded characters into a hash
+uint64_t mix(uint64_t hash, uint64_t word)
+{
+    hash ^= word * 0x9e3779b97f4a7c15ull;
+    hash  = (hash << 27) | (hash >> 37);
+    return hash * 0x100000001b3ull + 0x52dce729ull;
+}
+
+// Spreads the bits of a hash (the finalizer of MurmurHash3)
+uint64_t finish(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// A run of characters that fold to other characters: each character from first to last, in steps of stride, folds to
+// itself + delta. These are the simple case foldings of Unicode 14.0 that neither change the length of the UTF-8
+// encoding nor fold to ASCII, so a folded string has the same length as the original and its ASCII characters are
+// only folded by the table.
+struct FoldRun
+{
+    uint32_t first;
+    uint32_t last;
+    int32_t  delta;
+    uint32_t stride;
+};
+
+FoldRun const FOLD_RUNS[] =
+{
+    { 0x000b5, 0x000b5, 775, 1 },
+    { 0x000c0, 0x000d6, 32, 1 },
+    { 0x000d8, 0x000de, 32, 1 },
+    { 0x00100, 0x0012e, 1, 2 },
+    { 0x00132, 0x00136, 1, 2 },
+    { 0x00139, 0x00147, 1, 2 },
+    { 0x0014a, 0x00176, 1, 2 },
+    { 0x00178, 0x00178, -121, 1 },
+    { 0x00179, 0x0017d, 1, 2 },
+    { 0x00181, 0x00181, 210, 1 },
+    { 0x00182, 0x00184, 1, 2 },
+    { 0x00186, 0x00186, 206, 1 },
+    { 0x00187, 0x00187, 1, 1 },
+    { 0x00189, 0x0018a, 205, 1 },
+    { 0x0018b, 0x0018b, 1, 1 },
+    { 0x0018e, 0x0018e, 79, 1 },
+    { 0x0018f, 0x0018f, 202, 1 },
+    { 0x00190, 0x00190, 203, 1 },
+    { 0x00191, 0x00191, 1, 1 },
+    { 0x00193, 0x00193, 205, 1 },
+    { 0x00194, 0x00194, 207, 1 },
+    { 0x00196, 0x00196, 211, 1 },
+    { 0x00197, 0x00197, 209, 1 },
+    { 0x00198, 0x00198, 1, 1 },
+    { 0x0019c, 0x0019c, 211, 1 },
+    { 0x0019d, 0x0019d, 213, 1 },
+    { 0x0019f, 0x0019f, 214, 1 },
+    { 0x001a0, 0x001a4, 1, 2 },
+    { 0x001a6, 0x001a6, 218, 1 },
+    { 0x001a7, 0x001a7, 1, 1 },
+    { 0x001a9, 0x001a9, 218, 1 },
+    { 0x001ac, 0x001ac, 1, 1 },
+    { 0x001ae, 0x001ae, 218, 1 },
+    { 0x001af, 0x001af, 1, 1 },
+    { 0x001b1, 0x001b2, 217, 1 },
+    { 0x001b3, 0x001b5, 1, 2 },
+    { 0x001b7, 0x001b7, 219, 1 },
+    { 0x001b8, 0x001b8, 1, 1 },
+    { 0x001bc, 0x001bc, 1, 1 },
+    { 0x001c4, 0x001c4, 2, 1 },
+    { 0x001c5, 0x001c5, 1, 1 },
+    { 0x001c7, 0x001c7, 2, 1 },
+    { 0x001c8, 0x001c8, 1, 1 },
+    { 0x001ca, 0x001ca, 2, 1 },
+    { 0x001cb, 0x001db, 1, 2 },
+    { 0x001de, 0x001ee, 1, 2 },
+    { 0x001f1, 0x001f1, 2, 1 },
+    { 0x001f2, 0x001f4, 1, 2 },
+    { 0x001f6, 0x001f6, -97, 1 },
+    { 0x001f7, 0x001f7, -56, 1 },
+    { 0x001f8, 0x0021e, 1, 2 },
+    { 0x00220, 0x00220, -130, 1 },
+    { 0x00222, 0x00232, 1, 2 },
+    { 0x0023b, 0x0023b, 1, 1 },
+    { 0x0023d, 0x0023d, -163, 1 },
+    { 0x00241, 0x00241, 1, 1 },
+    { 0x00243, 0x00243, -195, 1 },
+    { 0x00244, 0x00244, 69, 1 },
+    { 0x00245, 0x00245, 71, 1 },
+    { 0x00246, 0x0024e, 1, 2 },
+    { 0x00345, 0x00345, 116, 1 },
+    { 0x00370, 0x00372, 1, 2 },
+    { 0x00376, 0x00376, 1, 1 },
+    { 0x0037f, 0x0037f, 116, 1 },
+    { 0x00386, 0x00386, 38, 1 },
+    { 0x00388, 0x0038a, 37, 1 },
+    { 0x0038c, 0x0038c, 64, 1 },
+    { 0x0038e, 0x0038f, 63, 1 },
+    { 0x00391, 0x003a1, 32, 1 },
+    { 0x003a3, 0x003ab, 32, 1 },
+    { 0x003c2, 0x003c2, 1, 1 },
+    { 0x003cf, 0x003cf, 8, 1 },
+    { 0x003d0, 0x003d0, -30, 1 },
+    { 0x003d1, 0x003d1, -25, 1 },
+    { 0x003d5, 0x003d5, -15, 1 },
+    { 0x003d6, 0x003d6, -22, 1 },
+    { 0x003d8, 0x003ee, 1, 2 },
+    { 0x003f0, 0x003f0, -54, 1 },
+    { 0x003f1, 0x003f1, -48, 1 },
+    { 0x003f4, 0x003f4, -60, 1 },
+    { 0x003f5, 0x003f5, -64, 1 },
+    { 0x003f7, 0x003f7, 1, 1 },
+    { 0x003f9, 0x003f9, -7, 1 },
+    { 0x003fa, 0x003fa, 1, 1 },
+    { 0x003fd, 0x003ff, -130, 1 },
+    { 0x00400, 0x0040f, 80, 1 },
+    { 0x00410, 0x0042f, 32, 1 },
+    { 0x00460, 0x00480, 1, 2 },
+    { 0x0048a, 0x004be, 1, 2 },
+    { 0x004c0, 0x004c0, 15, 1 },
+    { 0x004c1, 0x004cd, 1, 2 },
+    { 0x004d0, 0x0052e, 1, 2 },
+    { 0x00531, 0x00556, 48, 1 },
+    { 0x010a0, 0x010c5, 7264, 1 },
+    { 0x010c7, 0x010c7, 7264, 1 },
+    { 0x010cd, 0x010cd, 7264, 1 },
+    { 0x013f8, 0x013fd, -8, 1 },
+    { 0x01c88, 0x01c88, 35267, 1 },
+    { 0x01c90, 0x01cba, -3008, 1 },
+    { 0x01cbd, 0x01cbf, -3008, 1 },
+    { 0x01e00, 0x01e94, 1, 2 },
+    { 0x01e9b, 0x01e9b, -58, 1 },
+    { 0x01ea0, 0x01efe, 1, 2 },
+    { 0x01f08, 0x01f0f, -8, 1 },
+    { 0x01f18, 0x01f1d, -8, 1 },
+    { 0x01f28, 0x01f2f, -8, 1 },
+    { 0x01f38, 0x01f3f, -8, 1 },
+    { 0x01f48, 0x01f4d, -8, 1 },
+    { 0x01f59, 0x01f5f, -8, 2 },
+    { 0x01f68, 0x01f6f, -8, 1 },
+    { 0x01f88, 0x01f8f, -8, 1 },
+    { 0x01f98, 0x01f9f, -8, 1 },
+    { 0x01fa8, 0x01faf, -8, 1 },
+    { 0x01fb8, 0x01fb9, -8, 1 },
+    { 0x01fba, 0x01fbb, -74, 1 },
+    { 0x01fbc, 0x01fbc, -9, 1 },
+    { 0x01fc8, 0x01fcb, -86, 1 },
+    { 0x01fcc, 0x01fcc, -9, 1 },
+    { 0x01fd8, 0x01fd9, -8, 1 },
+    { 0x01fda, 0x01fdb, -100, 1 },
+    { 0x01fe8, 0x01fe9, -8, 1 },
+    { 0x01fea, 0x01feb, -112, 1 },
+    { 0x01fec, 0x01fec, -7, 1 },
+    { 0x01ff8, 0x01ff9, -128, 1 },
+    { 0x01ffa, 0x01ffb, -126, 1 },
+    { 0x01ffc, 0x01ffc, -9, 1 },
+    { 0x02132, 0x02132, 28, 1 },
+    { 0x02160, 0x0216f, 16, 1 },
+    { 0x02183, 0x02183, 1, 1 },
+    { 0x024b6, 0x024cf, 26, 1 },
+    { 0x02c00, 0x02c2f, 48, 1 },
+    { 0x02c60, 0x02c60, 1, 1 },
+    { 0x02c63, 0x02c63, -3814, 1 },
+    { 0x02c67, 0x02c6b, 1, 2 },
+    { 0x02c72, 0x02c72, 1, 1 },
+    { 0x02c75, 0x02c75, 1, 1 },
+    { 0x02c80, 0x02ce2, 1, 2 },
+    { 0x02ceb, 0x02ced, 1, 2 },
+    { 0x02cf2, 0x02cf2, 1, 1 },
+    { 0x0a640, 0x0a66c, 1, 2 },
+    { 0x0a680, 0x0a69a, 1, 2 },
+    { 0x0a722, 0x0a72e, 1, 2 },
+    { 0x0a732, 0x0a76e, 1, 2 },
+    { 0x0a779, 0x0a77b, 1, 2 },
+    { 0x0a77d, 0x0a77d, -35332, 1 },
+    { 0x0a77e, 0x0a786, 1, 2 },
+    { 0x0a78b, 0x0a78b, 1, 1 },
+    { 0x0a790, 0x0a792, 1, 2 },
+    { 0x0a796, 0x0a7a8, 1, 2 },
+    { 0x0a7b3, 0x0a7b3, 928, 1 },
+    { 0x0a7b4, 0x0a7c2, 1, 2 },
+    { 0x0a7c4, 0x0a7c4, -48, 1 },
+    { 0x0a7c6, 0x0a7c6, -35384, 1 },
+    { 0x0a7c7, 0x0a7c9, 1, 2 },
+    { 0x0a7d0, 0x0a7d0, 1, 1 },
+    { 0x0a7d6, 0x0a7d8, 1, 2 },
+    { 0x0a7f5, 0x0a7f5, 1, 1 },
+    { 0x0ab70, 0x0abbf, -38864, 1 },
+    { 0x0ff21, 0x0ff3a, 32, 1 },
+    { 0x10400, 0x10427, 40, 1 },
+    { 0x104b0, 0x104d3, 40, 1 },
+    { 0x10570, 0x1057a, 39, 1 },
+    { 0x1057c, 0x1058a, 39, 1 },
+    { 0x1058c, 0x10592, 39, 1 },
+    { 0x10594, 0x10595, 39, 1 },
+    { 0x10c80, 0x10cb2, 64, 1 },
+    { 0x118a0, 0x118bf, 32, 1 },
+    { 0x16e40, 0x16e5f, 32, 1 },
+    { 0x1e900, 0x1e921, 34, 1 },
+};
+
+// Returns the character that a non-ASCII character folds to
+uint32_t foldCodePoint(uint32_t c)
+{
+    size_t lo = 0;
+    size_t hi = sizeof(FOLD_RUNS) / sizeof(FOLD_RUNS[0]);
+    while (lo < hi)
+    {
+        size_t const mid = (lo + hi) / 2;
+        if (FOLD_RUNS[mid].last < c)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo < sizeof(FOLD_RUNS) / sizeof(FOLD_RUNS[0]))
+    {
+        FoldRun const & run = FOLD_RUNS[lo];
+        if (c >= run.first && (c - run.first) % run.stride == 0)
+            return static_cast<uint32_t>(static_cast<int32_t>(c) + run.delta);
+    }
+    return c;
+}
+
+// Folds the non-ASCII character at the start of s into out, and returns the number of bytes in it. At most size bytes
+// are read. An invalid or incomplete sequence is a single byte that folds to itself.
+size_t foldCharacter(const char * s, size_t size, unsigned char * out)
+{
+    unsigned char const lead = static_cast<unsigned char>(s[0]);
+    size_t              n    = 1;
+    if (lead >= 0xc2 && lead <= 0xdf)
+        n = 2;
+    else if (lead >= 0xe0 && lead <= 0xef)
+        n = 3;
+    else if (lead >= 0xf0 && lead <= 0xf4)
+        n = 4;
+
+    if (n > size)
+        n = 1;
+    uint32_t c = lead & (0x7f >> n);
+    for (size_t i = 1; i < n; ++i)
+    {
+        unsigned char const x = static_cast<unsigned char>(s[i]);
+        if ((x & 0xc0) != 0x80)
+        {
+            n = 1;
+            break;
+        }
+        c = (c << 6) | (x & 0x3f);
+    }
+
+    uint32_t folded = (n > 1) ? foldCodePoint(c) : c;
+    if (folded == c)
+    {
+        memcpy(out, s, n);
+        return n;
+    }
+
+    // The folded character has an encoding of the same length
+    for (size_t i = n - 1; i > 0; --i)
+    {
+        out[i]   = static_cast<unsigned char>(0x80 | (folded & 0x3f));
+        folded >>= 6;
+    }
+    out[0] = static_cast<unsigned char>(((0xff00 >> n) & 0xff) | folded);
+    return n;
+}
+
+// The folded bytes of a string, produced one at a time
+class FoldedBytes
+{
+public:
+
+    FoldedBytes(const char * s, size_t size) : s_(s), size_(size) {}
+
+    // Returns the next folded byte
+    unsigned char next()
+    {
+        if (used_ == count_)
+        {
+            unsigned char const c = static_cast<unsigned char>(*s_);
+            if (c < 0x80)
+            {
+                ++s_;
+                --size_;
+                return char_traits_path_char::fold(static_cast<char>(c));
+            }
+            count_ = foldCharacter(s_, size_, buffer_);
+            used_  = 0;
+            s_    += count_;
+            size_ -= count_;
+        }
+        return buffer_[used_++];
+    }
+
+    // Returns true if the next byte is the first byte of a character
+    bool atBoundary() const { return used_ == count_; }
+
+private:
+
+    const char *  s_;           // Next character
+    size_t        size_;        // Number of bytes following s_
+    unsigned char buffer_[4];   // Folded bytes of the current character
+    size_t        used_  = 0;   // Number of bytes of buffer_ returned
+    size_t        count_ = 0;   // Number of bytes in buffer_
+};
+
+// Mixes the characters of a string, folded by char_traits_path_char::fold(char), into a hash as little-endian 8-byte
+// words, and returns the number of characters mixed. The characters after the last whole word are not mixed.
+size_t mixWords(uint64_t & h, const char * first, size_t count)
+{
+    // The vector loop folds 16 characters at a time, and produces the same words as the scalar loop
+
+    size_t i = 0;
+
+#if defined(MISC_PATHNAME_SSE2)
+    for (; i + 16 <= count; i += 16)
+    {
+        uint64_t      words[2];
+        __m128i const x = fold16(_mm_loadu_si128(reinterpret_cast<__m128i const *>(first + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(words), x);
+        h = mix(mix(h, words[0]), words[1]);
+    }
+#endif // defined(MISC_PATHNAME_SSE2)
+
+    for (; i + 8 <= count; i += 8)
+    {
+        uint64_t word = 0;
+        for (size_t j = 0; j < 8; ++j)
+        {
+            word |= static_cast<uint64_t>(char_traits_path_char::fold(first[i + j])) << (8 * j);
+        }
+        h = mix(h, word);
+    }
+    return i;
+}
+
+// Mixes the last characters of a string (fewer than 8) as a word padded with zeros, and returns the final hash
+uint64_t finishWords(uint64_t h, const char * rest, size_t count)
+{
+    if (count > 0)
+    {
+        uint64_t word = 0;
+        for (size_t j = 0; j < count; ++j)
+        {
+            word |= static_cast<uint64_t>(char_traits_path_char::fold(rest[j])) << (8 * j);
+        }
+        h = mix(h, word);
+    }
+    return finish(h);
+}
+
+// Returns true if a string has only ASCII characters
+bool isAscii(const char * s, size_t size)
+{
+    size_t i = 0;
+#if defined(MISC_PATHNAME_SSE2)
+    __m128i bits = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16)
+    {
+        bits = _mm_or_si128(bits, _mm_loadu_si128(reinterpret_cast<__m128i const *>(s + i)));
+    }
+    if (_mm_movemask_epi8(bits) != 0)
+        return false;
+#endif // defined(MISC_PATHNAME_SSE2)
+    unsigned char bits8 = 0;
+    for (; i < size; ++i)
+    {
+        bits8 |= static_cast<unsigned char>(s[i]);
+    }
+    return (bits8 & 0x80) == 0;
+}
+
+} // anonymous namespace
+
+//! @param	_First1     first string
+//! @param	_First2     second string
+//! @param	_Count      number of characters to compare
+int char_traits_path_char::compare(const char * _First1, const char * _First2, size_t _Count)
+{
+    // Skip blocks that are ASCII and equal with a single branch per block. The first block that is not is rescanned
+    // below as far as its first non-ASCII character, which starts a run of UTF-8 folding. The blocks resume when both
+    // strings are at a character boundary again.
+    //
+    // Nothing outside [0, _Count) is read, so a sequence cut by _Count is incomplete and its bytes are compared as they
+    // are, as fold() and hash() treat an incomplete sequence at the end of a string.
+
+    size_t i = 0;
+    for (;;)
+    {
+#if defined(MISC_PATHNAME_AVX2)
+        for (; i + 32 <= _Count; i += 32)
+        {
+            __m256i const a = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(_First1 + i));
+            __m256i const b = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(_First2 + i));
+            if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) != 0 ||
+                _mm256_movemask_epi8(_mm256_cmpeq_epi8(fold32(a), fold32(b))) != -1)
+            {
+                break;
+            }
+        }
+#endif // defined(MISC_PATHNAME_AVX2)
+
+#if defined(MISC_PATHNAME_SSE2)
+        for (; i + 16 <= _Count; i += 16)
+        {
+            __m128i const a = _mm_loadu_si128(reinterpret_cast<__m128i const *>(_First1 + i));
+            __m128i const b = _mm_loadu_si128(reinterpret_cast<__m128i const *>(_First2 + i));
+            if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0 ||
+                _mm_movemask_epi8(_mm_cmpeq_epi8(fold16(a), fold16(b))) != 0xffff)
+            {
+                break;
+            }
+        }
+#endif // defined(MISC_PATHNAME_SSE2)
+
+        size_t const end = (_Count - i < 16) ? _Count : i + 16;
+        for (; i < end && ((_First1[i] | _First2[i]) & 0x80) == 0; ++i)
+        {
+            unsigned char const a = fold(_First1[i]);
+            unsigned char const b = fold(_First2[i]);
+            if (a != b)
+                return (a < b) ? -1 : +1;
+        }
+        if (i == _Count)
+            return 0;
+
+        if (i < end)
+        {
+            // Folding preserves lengths, so the folded bytes of both strings stay aligned
+            FoldedBytes a(_First1 + i, _Count - i);
+            FoldedBytes b(_First2 + i, _Count - i);
+            do
+            {
+                unsigned char const x = a.next();
+                unsigned char const y = b.next();
+                if (x != y)
+                    return (x < y) ? -1 : +1;
+                ++i;
+            } while (!a.atBoundary() || !b.atBoundary());
+        }
+    }
+}
+
+//! @param	_First      string to search
+//! @param	_Count      number of characters to search
+//! @param	_Ch         character to find
+const char * char_traits_path_char::find(const char * _First, size_t _Count, char _Ch)
+{
+    // Skip blocks without a match with a single branch per block. The first block with a match is rescanned below.
+
+    unsigned char const c = fold(_Ch);
+    size_t              i = 0;
+
+#if defined(MISC_PATHNAME_AVX2)
+    __m256i const c32 = _mm256_set1_epi8(static_cast<char>(c));
+    for (; i + 32 <= _Count; i += 32)
+    {
+        __m256i const x = fold32(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(_First + i)));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, c32)) != 0)
+            break;
+    }
+#endif // defined(MISC_PATHNAME_AVX2)
+
+#if defined(MISC_PATHNAME_SSE2)
+    __m128i const c16 = _mm_set1_epi8(static_cast<char>(c));
+    for (; i + 16 <= _Count; i += 16)
+    {
+        __m128i const x = fold16(_mm_loadu_si128(reinterpret_cast<__m128i const *>(_First + i)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, c16)) != 0)
+            break;
+    }
+#endif // defined(MISC_PATHNAME_SSE2)
+
+    for (; i < _Count; ++i)
+    {
+        if (fold(_First[i]) == c)
+            return _First + i;
+    }
+    return nullptr;
+}
+
+//! @param	_First      string to hash
+//! @param	_Count      number of characters in the string
+uint64_t char_traits_path_char::hash(const char * _First, size_t _Count)
+{
+    // The folded characters are hashed as little-endian 8-byte words, the last one padded with zeros. Non-ASCII strings
+    // are folded first, so that the hash is the same as for every string that compares equal. They are folded in chunks
+    // that end at a character boundary, and the characters after the last whole word of a chunk are carried over to
+    // the next one, so the words are the same as if the whole string had been folded at once.
+
+    uint64_t h = 0xcbf29ce484222325ull ^ _Count;
+    if (isAscii(_First, _Count))
+    {
+        size_t const mixed = mixWords(h, _First, _Count);
+        return finishWords(h, _First + mixed, _Count - mixed);
+    }
+
+    size_t const CHUNK_SIZE = 256;
+    char         folded[CHUNK_SIZE + 8];
+    size_t       carried = 0;   // Number of folded characters at the start of folded that have not been mixed
+    size_t       i       = 0;
+    while (i < _Count)
+    {
+        // A sequence has at most 3 continuation bytes, so if the 4 bytes from the end are all continuation bytes, no
+        // sequence crosses it
+        size_t const end = (_Count - i > CHUNK_SIZE) ? i + CHUNK_SIZE : _Count;
+        size_t       cut = end;
+        while (cut < _Count && cut > end - 3 && (_First[cut] & 0xc0) == 0x80)
+        {
+            --cut;
+        }
+        if (cut < _Count && (_First[cut] & 0xc0) == 0x80)
+            cut = end;
+
+        fold(_First + i, cut - i, folded + carried);
+        size_t const n     = carried + (cut - i);
+        size_t const mixed = mixWords(h, folded, n);
+        carried            = n - mixed;
+        memmove(folded, folded + mixed, carried);
+        i = cut;
+    }
+    return finishWords(h, folded, carried);
+}
+
+//! @param	_First      string to fold
+//! @param	_Count      number of characters in the string
+//! @param	_Dest       folded characters. It may be the same as _First.
+void char_traits_path_char::fold(const char * _First, size_t _Count, char * _Dest)
+{
+    size_t i = 0;
+    while (i < _Count)
+    {
+#if defined(MISC_PATHNAME_SSE2)
+        for (; i + 16 <= _Count; i += 16)
+        {
+            __m128i const x = _mm_loadu_si128(reinterpret_cast<__m128i const *>(_First + i));
+            if (_mm_movemask_epi8(x) != 0)
+                break;
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(_Dest + i), fold16(x));
+        }
+#endif // defined(MISC_PATHNAME_SSE2)
+
+        size_t const end = (_Count - i < 16) ? _Count : i + 16;
+        while (i < end)
+        {
+            if ((_First[i] & 0x80) == 0)
+            {
+                _Dest[i] = static_cast<char>(fold(_First[i]));
+                ++i;
+            }
+            else
+            {
+                unsigned char folded[4];
+                size_t const  n = foldCharacter(_First + i, _Count - i, folded);
+                memcpy(_Dest + i, folded, n);
+                i += n;
+            }
+        }
+    }
+}
+
+//! @param  path    Characters of the path, which are overwritten
+//! @param  size    Number of characters in the path
+size_t PathName::normalize(char * path, size_t size)
+{
+    // Components are copied down as they are read, so the output never overtakes the input. Removing a component for a
+    // ".." scans back over the output, but each character is removed at most once, so the time is linear.
+
+    if (size == 0)
+        return 0;
+
+    // The root is the part of the path that ".." does not remove: a drive such as "C:" and the separator after it, the
+    // "//server/share" of a UNC path, or a leading separator.
+    size_t in       = 0;
+    size_t out      = 0;
+    bool   absolute = false;
+    bool   unc      = false;
+    if (size >= 2 && path[1] == ':' && ((path[0] >= 'A' && path[0] <= 'Z') || (path[0] >= 'a' && path[0] <= 'z')))
+    {
+        in = out = 2;
+        if (in < size && char_traits_path_char::is_slash(path[in]))
+        {
+            path[out++] = '/';
+            absolute    = true;
+        }
+    }
+    else if (size >= 3 && char_traits_path_char::is_slash(path[0]) && char_traits_path_char::is_slash(path[1]) &&
+             !char_traits_path_char::is_slash(path[2]))
+    {
+        path[0] = path[1] = '/';
+        in = out = 2;
+        absolute = unc = true;
+        for (int name = 0; name < 2 && in < size; ++name)
+        {
+            while (in < size && char_traits_path_char::is_slash(path[in]))
+            {
+                ++in;
+            }
+            if (in < size && name > 0)
+                path[out++] = '/';
+            while (in < size && !char_traits_path_char::is_slash(path[in]))
+            {
+                path[out++] = path[in++];
+            }
+        }
+    }
+    else if (char_traits_path_char::is_slash(path[0]))
+    {
+        path[out++] = '/';
+        absolute    = true;
+    }
+    size_t const root = out;    // ".." does not remove anything before this
+
+    while (in < size)
+    {
+        while (in < size && char_traits_path_char::is_slash(path[in]))
+        {
+            ++in;
+        }
+        size_t const start = in;
+        while (in < size && !char_traits_path_char::is_slash(path[in]))
+        {
+            ++in;
+        }
+        size_t const length = in - start;
+
+        if (length == 0 || (length == 1 && path[start] == '.'))
+            continue;
+
+        if (length == 2 && path[start] == '.' && path[start + 1] == '.')
+        {
+            // Find the start of the previous component and remove it, unless it is a ".." that could not be removed
+            size_t last = out;
+            while (last > root && path[last - 1] != '/')
+            {
+                --last;
+            }
+            bool const unresolved = out - last == 2 && path[last] == '.' && path[last + 1] == '.';
+            if (out > root && !unresolved)
+            {
+                out = (last > root) ? last - 1 : root;
+                continue;
+            }
+            if (absolute)
+                continue;
+        }
+
+        if (out > root || unc)
+            path[out++] = '/';
+        for (size_t i = start; i < in; ++i)
+        {
+            path[out++] = path[i];
+        }
+    }
+
+    // The path was not empty, so there is room for the '.'
+    if (out == 0)
+        path[out++] = '.';
+    return out;
+}
+
+namespace
+{
+// A path being sorted, with 8 of its folded characters packed into an integer
+struct SortKey
+{
+    uint64_t     word;      // Folded characters at the current depth, big-endian and padded with zeros
+    uint32_t     count;     // Number of characters in word
+    uint32_t     index;     // Original position of the path
+    char const * data;      // Characters of the path
+    size_t       size;      // Number of characters in the path
+};
+
+// Packs the folded characters of a path starting at depth into its key. Comparing the words as integers is the same as
+// comparing the characters as unsigned bytes.
+void setWord(SortKey & key, size_t depth)
+{
+    size_t const n    = (key.size > depth) ? std::min<size_t>(key.size - depth, 8) : 0;
+    uint64_t     word = 0;
+    for (size_t j = 0; j < n; ++j)
+    {
+        word |= static_cast<uint64_t>(char_traits_path_char::fold(key.data[depth + j])) << (56 - 8 * j);
+    }
+    key.word  = word;
+    key.count = static_cast<uint32_t>(n);
+}
+
+void sortKeys(SortKey * begin, SortKey * end)
+{
+    // Each range is sorted by the 8 characters at its depth. A path that ends in those characters has a smaller count,
+    // so it sorts before the paths that continue. The paths in a run with the same 8 characters are sorted again by
+    // the next 8. Ties are broken by the original position, so the result is stable.
+
+    struct Range
+    {
+        SortKey * begin;
+        SortKey * end;
+        size_t    depth;
+    };
+
+    std::vector<Range> ranges { Range { begin, end, 0 } };
+    while (!ranges.empty())
+    {
+        Range const range = ranges.back();
+        ranges.pop_back();
+
+        for (SortKey * p = range.begin; p < range.end; ++p)
+        {
+            setWord(*p, range.depth);
+        }
+        std::sort(range.begin, range.end, [] (SortKey const & a, SortKey const & b) {
+            if (a.word != b.word)
+                return a.word < b.word;
+            if (a.count != b.count)
+                return a.count < b.count;
+            return a.index < b.index;
+        });
+
+        SortKey * p = range.begin;
+        while (p < range.end)
+        {
+            SortKey * q = p + 1;
+            while (q < range.end && q->word == p->word && q->count == p->count)
+            {
+                ++q;
+            }
+            if (p->count == 8 && q - p > 1)
+                ranges.push_back(Range { p, q, range.depth + 8 });
+            p = q;
+        }
+    }
+}
+
+template <typename Path>
+void sortPaths(std::vector<Path> & paths)
+{
+    // The keys of non-ASCII paths refer to folded copies, so that their characters are folded as compare() folds them.
+    // As in compare(), an incomplete sequence is not folded.
+    std::vector<SortKey>                 keys(paths.size());
+    std::vector<std::unique_ptr<char[]>> folded;
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        char const * data = paths[i].data();
+        size_t const size = paths[i].size();
+        if (!isAscii(data, size))
+        {
+            folded.emplace_back(new char[size]);
+            char_traits_path_char::fold(data, size, folded.back().get());
+            data = folded.back().get();
+        }
+        keys[i] = SortKey { 0, 0, static_cast<uint32_t>(i), data, size };
+    }
+    sortKeys(keys.data(), keys.data() + keys.size());
+
+    std::vector<Path> sorted;
+    sorted.reserve(paths.size());
+    for (SortKey const & key : keys)
+    {
+        sorted.push_back(std::move(paths[key.index]));
+    }
+    paths.swap(sorted);
+}
+} // anonymous namespace
+
+//! @param  paths   Paths to sort
+void PathName::sort(std::vector<PathName> & paths)
+{
+    sortPaths(paths);
+}
+
+//! @param  paths   Paths to sort
+void PathName::sort(std::vector<PathNameView> & paths)
+{
+    sortPaths(paths);
+}
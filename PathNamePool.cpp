@@ -0,0 +1,159 @@
+#include "PathNamePool.h"
+
+#include "PathName.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+namespace
+{
+uint32_t hashOf(std::string_view canonical)
+{
+    uint64_t const h = char_traits_path_char::hash(canonical.data(), canonical.size());
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+} // anonymous namespace
+
+PathNamePool::PathNamePool()
+    : slots_(1024)
+{
+}
+
+PathNamePool::~PathNamePool() = default;
+
+//! @param  path    Path to intern
+PathNamePool::Id PathNamePool::intern(std::string_view path)
+{
+    // The path is canonicalized and hashed before taking the lock. Most paths have been interned already, so they are
+    // looked up with a shared lock first.
+
+    thread_local std::string buffer;    // Reused, so canonicalizing a path does not allocate
+
+    canonicalize(path, buffer);
+    std::string_view const canonical = buffer;
+    uint32_t const         hash      = hashOf(canonical);
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        Id const id = lookup(canonical, hash);
+        if (id != INVALID)
+            return id;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    Id id = lookup(canonical, hash);
+    if (id != INVALID)
+        return id;
+
+    // A slot holds the ID + 1, so the ID INVALID would wrap to an empty slot. It is never assigned.
+    if (paths_.size() >= INVALID)
+        throw std::length_error("PathNamePool: too many paths");
+
+    if (paths_.size() + 1 > slots_.size() / 4 * 3)
+        grow();
+
+    id = static_cast<Id>(paths_.size());
+    paths_.push_back(store(canonical));
+    hashes_.push_back(hash);
+
+    size_t const mask = slots_.size() - 1;
+    size_t       slot = hash & mask;
+    while (slots_[slot].entry != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    slots_[slot] = Slot { hash, id + 1 };
+    return id;
+}
+
+//! @param  path    Path to find
+PathNamePool::Id PathNamePool::find(std::string_view path) const
+{
+    thread_local std::string buffer;
+    canonicalize(path, buffer);
+    std::string_view const              canonical = buffer;
+    uint32_t const                      hash      = hashOf(canonical);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return lookup(canonical, hash);
+}
+
+//! @param  id      ID of the path
+std::string_view PathNamePool::str(Id id) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return paths_[id];
+}
+
+size_t PathNamePool::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return paths_.size();
+}
+
+//! @param  path    Path to canonicalize
+std::string PathNamePool::canonicalize(std::string_view path)
+{
+    std::string canonical;
+    canonicalize(path, canonical);
+    return canonical;
+}
+
+void PathNamePool::canonicalize(std::string_view path, std::string & canonical)
+{
+    if (path.empty())
+    {
+        canonical = ".";
+        return;
+    }
+
+    canonical.assign(path.data(), path.size());
+    canonical.resize(PathName::normalize(&canonical[0], canonical.size()));
+    char_traits_path_char::fold(canonical.data(), canonical.size(), &canonical[0]);
+}
+
+PathNamePool::Id PathNamePool::lookup(std::string_view canonical, uint32_t hash) const
+{
+    size_t const mask = slots_.size() - 1;
+    for (size_t slot = hash & mask; slots_[slot].entry != 0; slot = (slot + 1) & mask)
+    {
+        if (slots_[slot].hash == hash && paths_[slots_[slot].entry - 1] == canonical)
+            return slots_[slot].entry - 1;
+    }
+    return INVALID;
+}
+
+std::string_view PathNamePool::store(std::string_view canonical)
+{
+    size_t const size = canonical.size() + 1;
+    if (size > available_)
+    {
+        size_t const blockSize = std::max(size, BLOCK_SIZE);
+        blocks_.emplace_back(new char[blockSize]);
+        next_      = blocks_.back().get();
+        available_ = blockSize;
+    }
+
+    char * const p = next_;
+    memcpy(p, canonical.data(), canonical.size());
+    p[canonical.size()] = 0;
+    next_      += size;
+    available_ -= size;
+    return std::string_view(p, canonical.size());
+}
+
+void PathNamePool::grow()
+{
+    // The stored hashes are reused, so no path is hashed again
+    slots_.assign(slots_.size() * 2, Slot {});
+    size_t const mask = slots_.size() - 1;
+    for (size_t id = 0; id < hashes_.size(); ++id)
+    {
+        size_t slot = hashes_[id] & mask;
+        while (slots_[slot].entry != 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+        slots_[slot] = Slot { hashes_[id], static_cast<uint32_t>(id + 1) };
+    }
+}
@@ -0,0 +1,294 @@
+#include "PathTrie.h"
+
+namespace
+{
+uint32_t hashOf(std::string_view c)
+{
+    uint64_t const h = char_traits_path_char::hash(c.data(), c.size());
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+// Returns true if a component of a path matches a component of a label
+bool matches(std::string_view c, std::string_view label)
+{
+    return c.size() == label.size() && char_traits_path_char::compare(c.data(), label.data(), c.size()) == 0;
+}
+} // anonymous namespace
+
+// The components of a path as keys of the trie. An absolute path begins with the component "/".
+class PathTrieBase::Key
+{
+public:
+
+    explicit Key(PathNameView path)
+        : begin_(path.data())
+        , i_(PathComponents(path).begin())
+        , root_(!path.empty() && char_traits_path_char::is_slash(path[0]))
+    {
+    }
+
+    // Returns true if there are no more components
+    bool done() const { return !root_ && i_ == PathComponents::iterator(); }
+
+    // Returns the current component
+    std::string_view operator *() const { return root_ ? std::string_view("/", 1) : *i_; }
+
+    // Returns a pointer past the current component in the path
+    char const * end() const { return root_ ? begin_ + 1 : i_->data() + i_->size(); }
+
+    // Advances to the next component
+    void next()
+    {
+        if (root_)
+            root_ = false;
+        else
+            ++i_;
+    }
+
+private:
+
+    char const *             begin_;    // Start of the path
+    PathComponents::iterator i_;        // Current component, unless it is the root
+    bool                     root_;     // True if the current component is the root of an absolute path
+};
+
+PathTrieBase::PathTrieBase()
+    : nodes_ { Node { 0, 0, NONE, NONE, 0, 0 } }
+    , edges_(16)
+{
+}
+
+void PathTrieBase::clear()
+{
+    nodes_.assign(1, Node { 0, 0, NONE, NONE, 0, 0 });
+    components_.clear();
+    text_.clear();
+    edges_.assign(16, Edge {});
+    nEdges_ = 0;
+}
+
+uint32_t PathTrieBase::add(PathNameView path)
+{
+    Key      key(path);
+    uint32_t node = 0;
+    while (!key.done())
+    {
+        std::string_view const c     = *key;
+        uint32_t const         hash  = hashOf(c);
+        uint32_t const         child = findChild(node, c, hash);
+        if (child == NONE)
+        {
+            // The rest of the path is the label of a new leaf
+            uint32_t const leaf  = addChild(node, hash);
+            uint32_t const first = static_cast<uint32_t>(components_.size());
+            for (; !key.done(); key.next())
+            {
+                std::string_view const k = *key;
+                components_.push_back(Component { static_cast<uint32_t>(text_.size()), static_cast<uint32_t>(k.size()) });
+                text_.append(k.data(), k.size());
+            }
+            nodes_[leaf].first = first;
+            nodes_[leaf].count = static_cast<uint32_t>(components_.size()) - first;
+            return leaf;
+        }
+
+        // Match the rest of the label, and split the node if the path leaves it
+        key.next();
+        uint32_t k = 1;
+        while (k < nodes_[child].count && !key.done() && matches(*key, component(nodes_[child].first + k)))
+        {
+            ++k;
+            key.next();
+        }
+        if (k < nodes_[child].count)
+            split(child, k);
+        node = child;
+    }
+    return node;
+}
+
+uint32_t PathTrieBase::find(PathNameView path) const
+{
+    Key      key(path);
+    uint32_t node = 0;
+    while (!key.done())
+    {
+        std::string_view const c = *key;
+        node = findChild(node, c, hashOf(c));
+        if (node == NONE)
+            return NONE;
+        key.next();
+        for (uint32_t k = 1; k < nodes_[node].count; ++k)
+        {
+            if (key.done() || !matches(*key, component(nodes_[node].first + k)))
+                return NONE;
+            key.next();
+        }
+    }
+    return node;
+}
+
+uint32_t PathTrieBase::findPrefix(PathNameView prefix, std::string & path) const
+{
+    // The prefix may end inside the label of a node, in which case every path under the node begins with it
+    Key      key(prefix);
+    uint32_t node = 0;
+    while (!key.done())
+    {
+        std::string_view const c = *key;
+        node = findChild(node, c, hashOf(c));
+        if (node == NONE)
+            return NONE;
+        key.next();
+        for (uint32_t k = 1; k < nodes_[node].count && !key.done(); ++k)
+        {
+            if (!matches(*key, component(nodes_[node].first + k)))
+                return NONE;
+            key.next();
+        }
+        appendLabel(node, path);
+    }
+    return node;
+}
+
+uint32_t PathTrieBase::findLongestPrefix(PathNameView path, size_t & matched) const
+{
+    uint32_t best = (nodes_[0].value != 0) ? 0 : NONE;
+    matched = 0;
+
+    Key      key(path);
+    uint32_t node = 0;
+    while (!key.done())
+    {
+        std::string_view const c = *key;
+        node = findChild(node, c, hashOf(c));
+        if (node == NONE)
+            break;
+        char const * end = key.end();
+        key.next();
+        uint32_t k = 1;
+        for (; k < nodes_[node].count && !key.done() && matches(*key, component(nodes_[node].first + k)); ++k)
+        {
+            end = key.end();
+            key.next();
+        }
+        if (k < nodes_[node].count)
+            break;
+        if (nodes_[node].value != 0)
+        {
+            best    = node;
+            matched = static_cast<size_t>(end - path.data());
+        }
+    }
+    return best;
+}
+
+void PathTrieBase::appendLabel(uint32_t node, std::string & path) const
+{
+    Node const & n = nodes_[node];
+    for (uint32_t i = n.first; i < n.first + n.count; ++i)
+    {
+        if (!path.empty() && path.back() != '/')
+            path += '/';
+        path += component(i);
+    }
+}
+
+size_t PathTrieBase::home(uint32_t parent, uint32_t hash) const
+{
+    return (hash ^ (parent * 0x9e3779b9u)) & (edges_.size() - 1);
+}
+
+uint32_t PathTrieBase::findChild(uint32_t parent, std::string_view c, uint32_t hash) const
+{
+    size_t const mask = edges_.size() - 1;
+    for (size_t slot = home(parent, hash); edges_[slot].child != 0; slot = (slot + 1) & mask)
+    {
+        Edge const & edge = edges_[slot];
+        if (edge.parent == parent && edge.hash == hash && matches(c, component(nodes_[edge.child].first)))
+            return edge.child;
+    }
+    return NONE;
+}
+
+uint32_t PathTrieBase::addChild(uint32_t parent, uint32_t hash)
+{
+    uint32_t const child = static_cast<uint32_t>(nodes_.size());
+    nodes_.push_back(Node { 0, 0, NONE, nodes_[parent].child, 0, hash });
+    nodes_[parent].child = child;
+    insertEdge(Edge { parent, hash, child });
+    return child;
+}
+
+void PathTrieBase::split(uint32_t node, uint32_t count)
+{
+    uint32_t const tail  = static_cast<uint32_t>(nodes_.size());
+    Node const     n     = nodes_[node];
+    uint32_t const first = n.first + count;
+    nodes_.push_back(Node { first, n.count - count, n.child, NONE, n.value, hashOf(component(first)) });
+
+    // The edges to the children are keyed by the parent, so they must be moved to the tail
+    for (uint32_t child = n.child; child != NONE; child = nodes_[child].sibling)
+    {
+        removeEdge(node, nodes_[child].hash, child);
+        insertEdge(Edge { tail, nodes_[child].hash, child });
+    }
+
+    nodes_[node].count = count;
+    nodes_[node].child = tail;
+    nodes_[node].value = 0;
+    insertEdge(Edge { node, nodes_[tail].hash, tail });
+}
+
+void PathTrieBase::insertEdge(Edge const & edge)
+{
+    // The table is doubled before it is 3/4 full
+    if (nEdges_ + 1 > edges_.size() / 4 * 3)
+    {
+        std::vector<Edge> old(edges_.size() * 2);
+        old.swap(edges_);
+        for (Edge const & e : old)
+        {
+            if (e.child != 0)
+            {
+                size_t slot = home(e.parent, e.hash);
+                while (edges_[slot].child != 0)
+                {
+                    slot = (slot + 1) & (edges_.size() - 1);
+                }
+                edges_[slot] = e;
+            }
+        }
+    }
+
+    size_t slot = home(edge.parent, edge.hash);
+    while (edges_[slot].child != 0)
+    {
+        slot = (slot + 1) & (edges_.size() - 1);
+    }
+    edges_[slot] = edge;
+    ++nEdges_;
+}
+
+void PathTrieBase::removeEdge(uint32_t parent, uint32_t hash, uint32_t child)
+{
+    size_t const mask = edges_.size() - 1;
+    size_t       hole = home(parent, hash);
+    while (edges_[hole].child != child)
+    {
+        hole = (hole + 1) & mask;
+    }
+
+    // The entries following the hole are shifted back so that no probe sequence is broken
+    for (size_t slot = (hole + 1) & mask; edges_[slot].child != 0; slot = (slot + 1) & mask)
+    {
+        size_t const h = home(edges_[slot].parent, edges_[slot].hash);
+        if (((slot - h) & mask) >= ((slot - hole) & mask))
+        {
+            edges_[hole] = edges_[slot];
+            hole         = slot;
+        }
+    }
+    edges_[hole] = Edge {};
+    --nEdges_;
+}
@@ -1,59 +1,128 @@
 #include "Probability.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+// Computes a * b for 0 <= a, b, and returns false if the result does not fit in an int64_t
+bool multiply(int64_t a, int64_t b, int64_t & result)
+{
+#if defined(__SIZEOF_INT128__)
+    __int128 const product = static_cast<__int128>(a) * b;
+    if (product > std::numeric_limits<int64_t>::max())
+        return false;
+    result = static_cast<int64_t>(product);
+    return true;
+#else
+    if (b != 0 && a > std::numeric_limits<int64_t>::max() / b)
+        return false;
+    result = a * b;
+    return true;
+#endif
+}
+} // anonymous namespace
+
 //! @param  x       X
 //!
-//! @warning    Bad things can happen if not 0 <= x <= 20.
+//! @warning    If x > 20, the result does not fit and INT64_MAX is returned. 0 is returned if x < 0.
 int64_t factorial(int64_t x)
 {
-    int64_t result = 1;
-    while (x > 1)
-    {
-        result *= x--;
-    }
-    return result;
+    return checkedFactorial(x).value_or(std::numeric_limits<int64_t>::max());
 }
 
 //! @param 	n   N
 //! @param 	r   R
 //!
-//! @warning    Bad things can happen if not 0 <= r <= n <= 20.
+//! @warning    If the result does not fit in an int64_t, INT64_MAX is returned. See checkedPermutations().
 int64_t permutations(int64_t n, int64_t r)
 {
-    // Computed as n * (n - 1) * (n - 2) * ... * (n - r + 1)
-    int64_t last = n - r + 1;
-    int64_t x = 1;
-    while (n >= last)
-    {
-        x *= n--;
-    }
-    return x;
+    return checkedPermutations(n, r).value_or(std::numeric_limits<int64_t>::max());
 }
 
 //! @param 	n   N
 //! @param 	k   K
 //!
-//! @warning    Bad things can happen if not 0 <= k <= n <= 20.
+//! @warning    If the result does not fit in an int64_t, INT64_MAX is returned. See checkedCombinations().
 int64_t combinations(int64_t n, int64_t k)
 {
-    // Note that there is a symmetry that allows some minor optimization.
-    if (k <= n - k)
-        return permutations(n, k) / factorial(k);
-    else
-        return permutations(n, n - k) / factorial(n - k);
+    return checkedCombinations(n, k).value_or(std::numeric_limits<int64_t>::max());
 }
 
 //! @param 	n   N
 //! @param 	k   K
 //!
-//! @warning    Bad things can happen if not 0 <= k <= 20 and 1 <= n.
+//! @warning    If the result does not fit in an int64_t, INT64_MAX is returned. See checkedMultisets().
 int64_t multisets(int64_t n, int64_t k)
 {
-    // Computed as n * (n + 1) * (n + 2) * ... * (n + k - 1) / k!
-    int64_t last = n + k - 1;
+    return checkedMultisets(n, k).value_or(std::numeric_limits<int64_t>::max());
+}
+
+//! @param  x       X
+//!
+//! 0 is returned if x < 0.
+std::optional<int64_t> checkedFactorial(int64_t x)
+{
+    return checkedPermutations(x, x);
+}
+
+//! @param 	n   N
+//! @param 	r   R
+//!
+//! 0 is returned if not 0 <= r <= n.
+std::optional<int64_t> checkedPermutations(int64_t n, int64_t r)
+{
+    if (r < 0 || n < r)
+        return 0;
+
+    // Computed as n * (n - 1) * (n - 2) * ... * (n - r + 1). The product only grows, so it stops at the first overflow.
+    // The loop counts the r factors rather than comparing with n - r + 1, which overflows if n is INT64_MAX and r is 0.
+    int64_t x = 1;
+    for (int64_t i = 0; i < r; ++i)
+    {
+        if (!multiply(x, n - i, x))
+            return std::nullopt;
+    }
+    return x;
+}
+
+//! @param 	n   N
+//! @param 	k   K
+//!
+//! 0 is returned if not 0 <= k <= n. The time is proportional to min(k, n - k).
+std::optional<int64_t> checkedCombinations(int64_t n, int64_t k)
+{
+    if (k < 0 || n < k)
+        return 0;
+
+    // nCk = nC(n - k), so the shorter product is used. After step i, x is (n - k + i)Ci, which only grows, so it stops
+    // at the first overflow. x * (n - k + i) is divisible by i, so once x and i are divided by their gcd, what remains
+    // of i divides n - k + i. Dividing first keeps the factors as small as possible.
+    k = std::min(k, n - k);
     int64_t x = 1;
-    while (n <= last)
+    for (int64_t i = 1; i <= k; ++i)
     {
-        x *= n++;
+        int64_t const g = std::gcd(x, i);
+        if (!multiply(x / g, (n - k + i) / (i / g), x))
+            return std::nullopt;
     }
-    return x / factorial(k);
+    return x;
+}
+
+//! @param 	n   N
+//! @param 	k   K
+//!
+//! 0 is returned if n < 0 or k < 0, or if n = 0 and k > 0.
+std::optional<int64_t> checkedMultisets(int64_t n, int64_t k)
+{
+    // Computed as (n + k - 1)Ck
+    if (n < 0 || k < 0)
+        return 0;
+    if (k == 0)
+        return 1;
+    if (n > std::numeric_limits<int64_t>::max() - (k - 1))
+        return std::nullopt;
+    return checkedCombinations(n + (k - 1), k);
 }
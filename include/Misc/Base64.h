@@ -15,13 +15,1112 @@
   Original: https://github.com/ReneNyffenegger/cpp-base64
 */
 
-
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace Base64
 {
-	std::string encode(unsigned char const* , size_t len);
-	std::string decode(std::string const& s);
+//! @name Alphabets
+//!
+//! An alphabet is a type with a 64-character (plus terminator) array member @c CHARS and a bool member @c PADDED. If
+//! @c PADDED is true, the encoded output is padded with '=' to a multiple of 4 characters. The encoding and decoding
+//! tables are built from @c CHARS at compile time, so a custom alphabet is as fast as the built-in ones. For example:
+//! @code
+//!
+//!     struct Crypt
+//!     {
+//!         static constexpr char CHARS[] = "./0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+//!         static constexpr bool PADDED  = false;
+//!     };
+//!
+//!     std::string s = Base64::encode<Crypt>(bytes, len); @endcode
+//@{
+
+//! The standard alphabet with padding (RFC 4648 section 4).
+struct Standard
+{
+    static constexpr char CHARS[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+        "abcdefghijklmnopqrstuvwxyz"
+        "0123456789+/";
+    static constexpr bool PADDED = true;
+};
+
+//! The standard alphabet without padding.
+struct StandardNoPad : Standard
+{
+    static constexpr bool PADDED = false;
+};
+
+//! The URL- and filename-safe alphabet with padding (RFC 4648 section 5).
+struct Url
+{
+    static constexpr char CHARS[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+        "abcdefghijklmnopqrstuvwxyz"
+        "0123456789-_";
+    static constexpr bool PADDED = true;
+};
+
+//! The URL- and filename-safe alphabet without padding, as used by JWT.
+struct UrlNoPad : Url
+{
+    static constexpr bool PADDED = false;
+};
+
+//@}
+
+//! Encodes a block of bytes.
+template <class Alphabet = Standard>
+std::string encode(unsigned char const * bytes, size_t len);
+
+//! Encodes a block of bytes, breaking the output into lines.
+//!
+//! @param  bytes       Bytes to encode
+//! @param  len         Number of bytes
+//! @param  lineLength  Maximum number of characters in a line, e.g. 64 for PEM or 76 for MIME. It is rounded down to a
+//!                     multiple of 4. If it is less than 4, the output is not broken into lines.
+//! @param  eol         Line separator. It is inserted between lines, but not after the last line.
+template <class Alphabet = Standard>
+std::string encode(unsigned char const * bytes, size_t len, size_t lineLength, std::string const & eol = "\r\n");
+
+//! Decodes a string.
+//!
+//! Decoding stops at the first '=' or non-base64 character. If @p ignoreWhitespace is true, spaces, tabs and line breaks
+//! are skipped instead, so PEM and MIME bodies can be decoded without removing the line breaks first.
+template <class Alphabet = Standard>
+std::string decode(std::string const & s, bool ignoreWhitespace = false);
+
+//! Decodes characters into a buffer.
+//!
+//! @param  s                   Characters to decode
+//! @param  len                 Number of characters
+//! @param  out                 Destination (must have room for maxDecodedSize(len) bytes). It may be the same as @p s.
+//! @param  ignoreWhitespace    If true, spaces, tabs and line breaks are skipped rather than ending the input
+//!
+//! @return     Number of bytes written
+template <class Alphabet = Standard>
+size_t decode(char const * s, size_t len, void * out, bool ignoreWhitespace = false);
+
+//! Decodes characters into a contiguous range of byte-sized elements, such as a std::array or std::vector.
+//!
+//! @param  s                   Characters to decode
+//! @param  len                 Number of characters
+//! @param  out                 Destination (its size must be at least maxDecodedSize(len))
+//! @param  ignoreWhitespace    If true, spaces, tabs and line breaks are skipped rather than ending the input
+//!
+//! @return     Number of bytes written
+template <class Alphabet = Standard, class Range>
+size_t decodeInto(char const * s, size_t len, Range & out, bool ignoreWhitespace = false);
+
+//! Decodes characters into a vector of bytes.
+//!
+//! @param  Byte    Element type of the result (std::byte, unsigned char, uint8_t, etc.)
+template <class Alphabet = Standard, class Byte = std::byte>
+std::vector<Byte> decodeBytes(char const * s, size_t len, bool ignoreWhitespace = false);
+
+//! Decodes a string into a vector of bytes.
+template <class Alphabet = Standard, class Byte = std::byte>
+std::vector<Byte> decodeBytes(std::string const & s, bool ignoreWhitespace = false)
+{
+    return decodeBytes<Alphabet, Byte>(s.data(), s.size(), ignoreWhitespace);
+}
+
+//! Decodes characters in place, overwriting them with the decoded bytes.
+//!
+//! This is safe because every decoded byte is written after the characters it is decoded from have been read.
+//!
+//! @return     Number of bytes written to the start of @p s
+template <class Alphabet = Standard>
+size_t decodeInPlace(char * s, size_t len, bool ignoreWhitespace = false)
+{
+    return decode<Alphabet>(s, len, s, ignoreWhitespace);
+}
+
+//! Decodes a string in place. The string is resized to the number of decoded bytes.
+template <class Alphabet = Standard>
+void decodeInPlace(std::string & s, bool ignoreWhitespace = false)
+{
+    s.resize(decodeInPlace<Alphabet>(&s[0], s.size(), ignoreWhitespace));
+}
+
+//! Kinds of errors found by decodeStrict() and validate().
+enum class Error
+{
+    NONE,           //!< No error
+    BAD_CHARACTER,  //!< A character is not in the alphabet
+    BAD_PADDING,    //!< Padding is misplaced, missing, or not allowed, or the input ends in the middle of a quantum
+    NON_CANONICAL   //!< The unused bits of the last character are not 0
+};
+
+//! The result of decodeStrict() and validate().
+struct Result
+{
+    Error  error;       //!< Kind of error
+    size_t position;    //!< Position of the character in error, or the length of the input if the input ends early
+
+    //! Returns true if there is no error.
+    explicit operator bool() const { return error == Error::NONE; }
+};
+
+//! Decodes a string, checking that it is canonical base64.
+//!
+//! Unlike decode(), any character that is not in the alphabet is an error, and the padding and the unused bits of the
+//! last quantum are checked. Errors are found in the same pass as the decoding.
+//!
+//! @param  s           Characters to decode
+//! @param  len         Number of characters
+//! @param  out         Destination (must have room for maxDecodedSize(len) bytes). It may be the same as @p s.
+//! @param  written     Number of bytes written. If there is an error, only the quanta preceding it are written.
+//!
+//! @return     The first error in the input, if any
+template <class Alphabet = Standard>
+Result decodeStrict(char const * s, size_t len, unsigned char * out, size_t & written);
+
+//! Decodes a string, checking that it is canonical base64.
+//!
+//! @param  s           String to decode
+//! @param  out         Decoded bytes. If there is an error, only the quanta preceding it are decoded.
+//!
+//! @return     The first error in the input, if any
+template <class Alphabet = Standard>
+Result decodeStrict(std::string const & s, std::string & out);
+
+//! Checks that a string is canonical base64 without decoding it.
+//!
+//! The checks are the same as those made by decodeStrict(). For alphabets that consist of the letters and digits plus
+//! two other characters (such as Standard and Url), the characters are checked 64 at a time with SSE2.
+//!
+//! @return     The first error in the input, if any
+template <class Alphabet = Standard>
+Result validate(char const * s, size_t len);
+
+//! Checks that a string is canonical base64 without decoding it.
+template <class Alphabet = Standard>
+Result validate(std::string const & s) { return validate<Alphabet>(s.data(), s.size()); }
+
+//! Encodes a block of bytes using multiple threads.
+//!
+//! The input is split on 3-byte boundaries and each thread writes its part directly into the output. Inputs smaller
+//! than PARALLEL_THRESHOLD are encoded on the calling thread.
+//!
+//! @param  bytes       Bytes to encode
+//! @param  len         Number of bytes
+//! @param  nThreads    Maximum number of threads to use (0 means std::thread::hardware_concurrency())
+//!
+//! @return     The same result as encode(bytes, len)
+template <class Alphabet = Standard>
+std::string encodeParallel(unsigned char const * bytes, size_t len, unsigned nThreads = 0);
+
+//! Decodes a string using multiple threads.
+//!
+//! The input is split on 4-character boundaries and each thread writes its part directly into the output. Inputs
+//! smaller than PARALLEL_THRESHOLD are decoded on the calling thread.
+//!
+//! @param  s           String to decode
+//! @param  nThreads    Maximum number of threads to use (0 means std::thread::hardware_concurrency())
+//!
+//! @return     The same result as decode(s)
+template <class Alphabet = Standard>
+std::string decodeParallel(std::string const & s, unsigned nThreads = 0);
+
+//! Encodes a block of bytes into a buffer using multiple threads.
+//!
+//! @param  bytes       Bytes to encode
+//! @param  len         Number of bytes
+//! @param  out         Destination (must have room for encodedSize(len) characters)
+//! @param  nThreads    Maximum number of threads to use (0 means std::thread::hardware_concurrency())
+//!
+//! @return     Number of characters written
+template <class Alphabet = Standard>
+size_t encodeParallel(unsigned char const * bytes, size_t len, char * out, unsigned nThreads = 0);
+
+//! Decodes characters into a buffer using multiple threads.
+//!
+//! @param  s           Characters to decode
+//! @param  len         Number of characters
+//! @param  out         Destination (must have room for maxDecodedSize(len) bytes)
+//! @param  nThreads    Maximum number of threads to use (0 means std::thread::hardware_concurrency())
+//!
+//! @return     Number of bytes written
+template <class Alphabet = Standard>
+size_t decodeParallel(char const * s, size_t len, unsigned char * out, unsigned nThreads = 0);
+
+//! Inputs smaller than this number of bytes are not split across threads.
+size_t constexpr PARALLEL_THRESHOLD = 1 << 20;
+
+//! Returns the number of characters produced by encoding @p len bytes.
+template <class Alphabet = Standard>
+constexpr size_t encodedSize(size_t len)
+{
+    return Alphabet::PADDED ? (len + 2) / 3 * 4 : (len * 4 + 2) / 3;
+}
+
+//! Returns the number of characters produced by encoding @p len bytes into lines of @p lineLength characters separated
+//! by @p eolLength characters. As in encode(), @p lineLength is rounded down to a multiple of 4, and the output is not
+//! broken into lines if it is less than 4.
+template <class Alphabet = Standard>
+constexpr size_t encodedSize(size_t len, size_t lineLength, size_t eolLength)
+{
+    size_t const n    = encodedSize<Alphabet>(len);
+    size_t const line = lineLength / 4 * 4;
+    return (n > 0 && line > 0) ? n + (n - 1) / line * eolLength : n;
+}
+
+//! Returns the maximum number of bytes produced by decoding @p len characters.
+constexpr size_t maxDecodedSize(size_t len) { return (len + 3) / 4 * 3; }
+
+//! @name Compile-time encoding and decoding
+//!
+//! These functions are constexpr, so encoded assets embedded as string literals can be decoded by the compiler. For
+//! example:
+//! @code
+//!
+//!     constexpr auto HELLO = BASE64_DECODE_LITERAL("SGVsbG8=");   // std::array<unsigned char, 5> @endcode
+//@{
+
+//! Encodes the characters of a string literal, not including the terminator.
+template <class Alphabet = Standard, size_t N>
+constexpr std::array<char, encodedSize<Alphabet>(N - 1)> encodeLiteral(char const (&s)[N]);
+
+//! Returns the number of bytes decoded from a string literal. As with decode(), decoding stops at the first '=' or
+//! non-base64 character.
+template <class Alphabet = Standard, size_t N>
+constexpr size_t decodedSize(char const (&s)[N]);
+
+//! Decodes a string literal.
+//!
+//! @param  M   Size of the result. It must be decodedSize(s), otherwise std::logic_error is thrown (which is a
+//!             compile-time error if the call is evaluated at compile time).
+template <size_t M, class Alphabet = Standard, size_t N>
+constexpr std::array<unsigned char, M> decodeLiteral(char const (&s)[N]);
+
+//! Decodes a string literal using the standard alphabet, into an array of the correct size.
+//!
+//! @hideinitializer
+#define BASE64_DECODE_LITERAL(s) Base64::decodeLiteral<Base64::decodedSize(s)>(s)
+
+//@}
+
+//! An incremental encoder.
+//!
+//! Input is given in chunks of any size with update(), and the final quantum and padding are written by finish(). The
+//! 0-2 bytes that do not complete a quantum are carried over to the next call, so the concatenated output is identical
+//! to the output of encode() for the concatenated input.
+//!
+//! @param  Alphabet    Alphabet and padding policy
+template <class Alphabet = Standard>
+class BasicEncoder
+{
+public:
+
+    //! Constructor.
+    BasicEncoder() = default;
+
+    //! Constructor.
+    //!
+    //! @param  lineLength  Maximum number of characters in a line. It is rounded down to a multiple of 4, since lines
+    //!                     hold whole groups. If it is less than 4, the output is not broken into lines.
+    //! @param  eol         Line separator. It is inserted between lines, but not after the last line.
+    BasicEncoder(size_t lineLength, std::string eol = "\r\n")
+        : lineLength_(lineLength / 4 * 4)
+        , column_(0)
+        , eol_(std::move(eol))
+    {
+    }
+
+    //! Encodes a chunk of bytes.
+    //!
+    //! @param  bytes   Bytes to encode
+    //! @param  len     Number of bytes
+    //! @param  out     Destination (must have room for encodedSize(len + 2) characters, plus line separators)
+    //!
+    //! @return     Number of characters written
+    size_t update(unsigned char const * bytes, size_t len, char * out);
+
+    //! Encodes a chunk of bytes, appending the result to @p out.
+    void update(unsigned char const * bytes, size_t len, std::string & out);
+
+    //! Encodes the remaining bytes with padding and resets the encoder.
+    //!
+    //! @param  out     Destination (must have room for 4 characters plus a line separator)
+    //!
+    //! @return     Number of characters written
+    size_t finish(char * out);
+
+    //! Encodes the remaining bytes with padding, appending the result to @p out, and resets the encoder.
+    void finish(std::string & out);
+
+private:
+    // Encodes complete groups, inserting line separators as needed. Returns the number of characters written.
+    size_t put(unsigned char const * in, size_t groups, char * out);
+
+    // Returns an upper bound on the number of characters written for n encoded characters
+    size_t maxOutput(size_t n) const { return lineLength_ ? n + (n / lineLength_ + 1) * eol_.size() : n; }
+
+    unsigned char pending_[3];  // Bytes carried over from the previous call, completed to a group
+    size_t nPending_   = 0;     // Number of bytes in pending_
+    size_t lineLength_ = 0;     // Maximum line length, or 0 if the output is not broken into lines
+    size_t column_     = 0;     // Number of characters in the current line
+    std::string eol_;           // Line separator
+};
+
+//! An incremental decoder.
+//!
+//! Input is given in chunks of any size with update(), and the final partial quantum is written by finish(). The 0-3
+//! characters that do not complete a quantum are carried over to the next call, so the concatenated output is identical
+//! to the output of decode() for the concatenated input. As with decode(), the first '=' or non-base64 character ends
+//! the input and everything after it is ignored.
+//!
+//! @param  Alphabet    Alphabet and padding policy
+template <class Alphabet = Standard>
+class BasicDecoder
+{
+public:
+
+    //! Constructor.
+    //!
+    //! @param  ignoreWhitespace    If true, spaces, tabs and line breaks are skipped rather than ending the input
+    explicit BasicDecoder(bool ignoreWhitespace = false)
+        : ignoreWhitespace_(ignoreWhitespace)
+    {
+    }
+
+    //! Decodes a chunk of characters.
+    //!
+    //! @param  chars   Characters to decode
+    //! @param  len     Number of characters
+    //! @param  out     Destination (must have room for maxDecodedSize(len) bytes)
+    //!
+    //! @return     Number of bytes written
+    size_t update(char const * chars, size_t len, unsigned char * out);
+
+    //! Decodes a chunk of characters, appending the result to @p out.
+    void update(char const * chars, size_t len, std::string & out);
+
+    //! Decodes the remaining characters and resets the decoder.
+    //!
+    //! @param  out     Destination (must have room for 2 bytes)
+    //!
+    //! @return     Number of bytes written (0-2)
+    size_t finish(unsigned char * out);
+
+    //! Decodes the remaining characters, appending the result to @p out, and resets the decoder.
+    void finish(std::string & out);
+
+    //! Returns true if the end of the input has been found.
+    bool done() const { return done_; }
+
+private:
+    unsigned char pending_[4];  // Decoded values of the characters carried over from the previous call
+    size_t nPending_       = 0;     // Number of values in pending_
+    bool done_             = false; // True if a terminating character has been found
+    bool ignoreWhitespace_ = false; // True if whitespace is skipped
+};
+
+using Encoder = BasicEncoder<Standard>; //!< An incremental encoder using the standard alphabet
+using Decoder = BasicDecoder<Standard>; //!< An incremental decoder using the standard alphabet
+
+namespace detail
+{
+unsigned char constexpr INVALID = 0xff;   // Decoded value of a character that is not in the alphabet
+unsigned char constexpr SPACE   = 0xfe;   // Decoded value of a whitespace character
+
+struct DecodeTable
+{
+    unsigned char values[256];
+
+    constexpr unsigned char operator [](char c) const { return values[static_cast<unsigned char>(c)]; }
+};
+
+constexpr bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+constexpr DecodeTable makeDecodeTable(char const * chars)
+{
+    DecodeTable table {};
+    for (int i = 0; i < 256; ++i)
+    {
+        table.values[i] = isSpace(static_cast<char>(i)) ? SPACE : INVALID;
+    }
+    for (int i = 0; i < 64; ++i)
+    {
+        table.values[static_cast<unsigned char>(chars[i])] = static_cast<unsigned char>(i);
+    }
+    return table;
+}
+
+// Returns true if the alphabet has 64 distinct characters, none of which is '=' or whitespace
+constexpr bool isValidAlphabet(char const * chars)
+{
+    for (int i = 0; i < 64; ++i)
+    {
+        if (chars[i] == 0 || chars[i] == '=' || isSpace(chars[i]))
+            return false;
+        for (int j = 0; j < i; ++j)
+        {
+            if (chars[i] == chars[j])
+                return false;
+        }
+    }
+    return chars[64] == 0;
+}
+
+template <class Alphabet>
+struct Tables
+{
+    static_assert(isValidAlphabet(Alphabet::CHARS), "An alphabet must have 64 distinct characters other than '='");
+
+    static constexpr char const * ENCODE = Alphabet::CHARS;
+    static constexpr DecodeTable  DECODE = makeDecodeTable(Alphabet::CHARS);
+};
+
+// Encodes n complete 3-byte groups
+template <class Alphabet, typename Byte>
+constexpr void encodeGroups(Byte const * in, size_t n, char * out)
+{
+    char const * const table = Tables<Alphabet>::ENCODE;
+    for (size_t i = 0; i < n; ++i)
+    {
+        unsigned int const x = (static_cast<unsigned char>(in[0]) << 16) |
+                               (static_cast<unsigned char>(in[1]) << 8) |
+                                static_cast<unsigned char>(in[2]);
+        out[0] = table[(x >> 18) & 0x3f];
+        out[1] = table[(x >> 12) & 0x3f];
+        out[2] = table[(x >>  6) & 0x3f];
+        out[3] = table[ x        & 0x3f];
+        in  += 3;
+        out += 4;
+    }
+}
+
+// Encodes the last 1 or 2 bytes and the padding, if any. Returns the number of characters written.
+template <class Alphabet, typename Byte>
+constexpr size_t encodeTail(Byte const * in, size_t n, char * out)
+{
+    char const * const table = Tables<Alphabet>::ENCODE;
+    unsigned int const x     = (static_cast<unsigned char>(in[0]) << 16) |
+                               ((n > 1) ? (static_cast<unsigned char>(in[1]) << 8) : 0);
+    out[0] = table[(x >> 18) & 0x3f];
+    out[1] = table[(x >> 12) & 0x3f];
+    if (n > 1)
+        out[2] = table[(x >> 6) & 0x3f];
+    if constexpr (Alphabet::PADDED)
+    {
+        if (n == 1)
+            out[2] = '=';
+        out[3] = '=';
+        return 4;
+    }
+    else
+    {
+        return n + 1;
+    }
+}
+
+// Decodes complete 4-character groups until the input ends or a group contains a character that is not base64. Returns
+// the number of groups decoded.
+template <class Alphabet>
+constexpr size_t decodeGroups(char const * in, size_t n, unsigned char * out)
+{
+    DecodeTable const & table = Tables<Alphabet>::DECODE;
+    size_t i = 0;
+    for (; i < n; ++i)
+    {
+        unsigned int const a = table[in[0]];
+        unsigned int const b = table[in[1]];
+        unsigned int const c = table[in[2]];
+        unsigned int const d = table[in[3]];
+        if (((a | b | c | d) & 0xc0) != 0)
+            break;
+
+        unsigned int const x = (a << 18) | (b << 12) | (c << 6) | d;
+        out[0] = static_cast<unsigned char>(x >> 16);
+        out[1] = static_cast<unsigned char>(x >> 8);
+        out[2] = static_cast<unsigned char>(x);
+        in  += 4;
+        out += 3;
+    }
+    return i;
+}
+
+// Decodes a complete quantum of 6-bit values
+constexpr void decodeQuantum(unsigned char const * values, unsigned char * out)
+{
+    out[0] = static_cast<unsigned char>((values[0] << 2) | (values[1] >> 4));
+    out[1] = static_cast<unsigned char>((values[1] << 4) | (values[2] >> 2));
+    out[2] = static_cast<unsigned char>((values[2] << 6) | values[3]);
+}
+
+// Returns true if the first 62 characters of the alphabet are the letters and digits in the standard order
+constexpr bool hasAlnumPrefix(char const * chars)
+{
+    for (int i = 0; i < 62; ++i)
+    {
+        if (chars[i] != Standard::CHARS[i])
+            return false;
+    }
+    return true;
+}
+
+// Returns the position of the first character that is not a letter, a digit, c62, or c63, or len if there is none
+size_t findInvalidAlnum(char const * s, size_t len, char c62, char c63);
+
+// Returns the position of the first character that is not in the alphabet, or len if there is none
+template <class Alphabet>
+size_t findInvalid(char const * s, size_t len)
+{
+    if constexpr (hasAlnumPrefix(Alphabet::CHARS))
+    {
+        return findInvalidAlnum(s, len, Alphabet::CHARS[62], Alphabet::CHARS[63]);
+    }
+    else
+    {
+        // Check 16 characters at a time, with a single branch per block
+        DecodeTable const & table = Tables<Alphabet>::DECODE;
+        size_t i = 0;
+        for (; i + 16 <= len; i += 16)
+        {
+            unsigned int flags = 0;
+            for (size_t j = 0; j < 16; ++j)
+            {
+                flags |= table[s[i + j]];
+            }
+            if ((flags & 0xc0) != 0)
+                break;
+        }
+        while (i < len && table[s[i]] < 64)
+        {
+            ++i;
+        }
+        return i;
+    }
+}
+
+// Checks the end of a strictly decoded input, starting at position p, which is the start of the first quantum that has
+// not been decoded. If out is not null, the bytes of the last quantum are written to it and written is incremented.
+template <class Alphabet>
+Result finishStrict(char const * s, size_t n, size_t p, unsigned char * out, size_t & written)
+{
+    DecodeTable const & table = Tables<Alphabet>::DECODE;
+
+    unsigned char values[4] = { 0, 0, 0, 0 };
+    size_t        k         = 0;
+    size_t        i         = p;
+    for (; i < n && k < 4; ++i)
+    {
+        unsigned char const value = table[s[i]];
+        if (value >= 64)
+            break;
+        values[k++] = value;
+    }
+
+    if (i < n)
+    {
+        // s[i] is not in the alphabet. If it is padding, then the padding must complete the quantum and end the input.
+        if (s[i] != '=')
+            return { Error::BAD_CHARACTER, i };
+        if (!Alphabet::PADDED || k < 2)
+            return { Error::BAD_PADDING, i };
+        for (size_t j = i; j < p + 4; ++j)
+        {
+            if (j >= n || s[j] != '=')
+                return { Error::BAD_PADDING, j };
+        }
+        if (p + 4 < n)
+            return { Error::BAD_PADDING, p + 4 };
+    }
+    else if (k == 1 || (Alphabet::PADDED && k > 0))
+    {
+        return { Error::BAD_PADDING, n };
+    }
+
+    if (k == 2 && (values[1] & 0x0f) != 0)
+        return { Error::NON_CANONICAL, p + 1 };
+    if (k == 3 && (values[2] & 0x03) != 0)
+        return { Error::NON_CANONICAL, p + 2 };
+
+    if (out && k > 1)
+    {
+        unsigned char quantum[3];
+        decodeQuantum(values, quantum);
+        for (size_t j = 0; j < k - 1; ++j)
+        {
+            out[j] = quantum[j];
+        }
+        written += k - 1;
+    }
+    return { Error::NONE, n };
+}
+
+// Decodes the characters of the last partial quantum, starting at position p and stopping at the first character that is
+// not in the alphabet. Returns the number of bytes written.
+template <class Alphabet>
+constexpr size_t decodeLast(char const * s, size_t n, size_t p, unsigned char * out)
+{
+    DecodeTable const & table = Tables<Alphabet>::DECODE;
+
+    unsigned char values[4] = { 0, 0, 0, 0 };
+    size_t        k         = 0;
+    for (size_t i = p; i < n && k < 4; ++i)
+    {
+        unsigned char const value = table[s[i]];
+        if (value >= 64)
+            break;
+        values[k++] = value;
+    }
+    if (k < 2)
+        return 0;
+
+    unsigned char quantum[3] = { 0, 0, 0 };
+    decodeQuantum(values, quantum);
+    for (size_t j = 0; j < k - 1; ++j)
+    {
+        out[j] = quantum[j];
+    }
+    return k - 1;
+}
+
+// Returns the number of threads to use for an input of the given size
+unsigned threadCount(size_t len, unsigned nThreads);
+
+// Calls f(i) for i in [0, n), with each call on its own thread. The last call is made on the calling thread.
+template <typename F>
+void forEachOnThread(unsigned n, F f)
+{
+    std::vector<std::thread> threads;
+    threads.reserve(n - 1);
+    for (unsigned i = 0; i + 1 < n; ++i)
+    {
+        threads.emplace_back(f, i);
+    }
+    f(n - 1);
+    for (auto & t : threads)
+    {
+        t.join();
+    }
+}
+} // namespace detail
+
+template <class Alphabet>
+std::string encode(unsigned char const * bytes, size_t len)
+{
+    std::string ret(encodedSize<Alphabet>(len), 0);
+    BasicEncoder<Alphabet> encoder;
+    size_t n = encoder.update(bytes, len, &ret[0]);
+    n += encoder.finish(&ret[n]);
+    ret.resize(n);
+    return ret;
+}
+
+template <class Alphabet>
+std::string encode(unsigned char const * bytes, size_t len, size_t lineLength, std::string const & eol)
+{
+    std::string ret(encodedSize<Alphabet>(len, lineLength, eol.size()), 0);
+    BasicEncoder<Alphabet> encoder(lineLength, eol);
+    size_t n = encoder.update(bytes, len, &ret[0]);
+    n += encoder.finish(&ret[n]);
+    ret.resize(n);
+    return ret;
+}
+
+template <class Alphabet>
+std::string decode(std::string const & s, bool ignoreWhitespace)
+{
+    std::string ret(maxDecodedSize(s.size()), 0);
+    ret.resize(decode<Alphabet>(s.data(), s.size(), &ret[0], ignoreWhitespace));
+    return ret;
+}
+
+template <class Alphabet>
+size_t decode(char const * s, size_t len, void * out, bool ignoreWhitespace)
+{
+    unsigned char * const  bytes = static_cast<unsigned char *>(out);
+    BasicDecoder<Alphabet> decoder(ignoreWhitespace);
+    size_t n = decoder.update(s, len, bytes);
+    n += decoder.finish(bytes + n);
+    return n;
+}
+
+template <class Alphabet, class Range>
+size_t decodeInto(char const * s, size_t len, Range & out, bool ignoreWhitespace)
+{
+    static_assert(sizeof(*std::data(out)) == 1, "The destination must be a range of byte-sized elements");
+    static_assert(!std::is_const<std::remove_reference_t<decltype(*std::data(out))>>::value, "The destination must be writable");
+    assert(std::size(out) >= maxDecodedSize(len));
+    return decode<Alphabet>(s, len, std::data(out), ignoreWhitespace);
+}
+
+template <class Alphabet, class Byte>
+std::vector<Byte> decodeBytes(char const * s, size_t len, bool ignoreWhitespace)
+{
+    static_assert(sizeof(Byte) == 1, "The element type must be byte-sized");
+    std::vector<Byte> ret(maxDecodedSize(len));
+    ret.resize(decode<Alphabet>(s, len, ret.data(), ignoreWhitespace));
+    return ret;
+}
+
+template <class Alphabet, size_t N>
+constexpr std::array<char, encodedSize<Alphabet>(N - 1)> encodeLiteral(char const (&s)[N])
+{
+    std::array<char, encodedSize<Alphabet>(N - 1)> ret {};
+    size_t const groups = (N - 1) / 3;
+    detail::encodeGroups<Alphabet>(s, groups, ret.data());
+    if ((N - 1) % 3 != 0)
+        detail::encodeTail<Alphabet>(s + groups * 3, (N - 1) % 3, ret.data() + groups * 4);
+    return ret;
+}
+
+template <class Alphabet, size_t N>
+constexpr size_t decodedSize(char const (&s)[N])
+{
+    detail::DecodeTable const & table = detail::Tables<Alphabet>::DECODE;
+
+    size_t len = 0;
+    while (len < N - 1 && table[s[len]] < 64)
+    {
+        ++len;
+    }
+    return len / 4 * 3 + ((len % 4 > 1) ? len % 4 - 1 : 0);
+}
+
+template <size_t M, class Alphabet, size_t N>
+constexpr std::array<unsigned char, M> decodeLiteral(char const (&s)[N])
+{
+    // The buffer has room for two extra groups so that an incorrect M is reported rather than overrunning the buffer
+    unsigned char buffer[M + 6] = {};
+    size_t const  decoded = detail::decodeGroups<Alphabet>(s, std::min((N - 1) / 4, M / 3 + 1), buffer);
+    size_t const  n       = decoded * 3 + detail::decodeLast<Alphabet>(s, N - 1, decoded * 4, buffer + decoded * 3);
+    if (n != M)
+        throw std::logic_error("Base64::decodeLiteral: M must be decodedSize(s)");
+
+    std::array<unsigned char, M> ret {};
+    for (size_t i = 0; i < M; ++i)
+    {
+        ret[i] = buffer[i];
+    }
+    return ret;
+}
+
+template <class Alphabet>
+Result decodeStrict(char const * s, size_t len, unsigned char * out, size_t & written)
+{
+    // Decode in bulk until the last quantum or a bad character, and then check the rest
+    size_t const groups  = len / 4;
+    size_t const decoded = detail::decodeGroups<Alphabet>(s, groups, out);
+    written = decoded * 3;
+    return detail::finishStrict<Alphabet>(s, len, decoded * 4, out + written, written);
+}
+
+template <class Alphabet>
+Result decodeStrict(std::string const & s, std::string & out)
+{
+    out.resize(maxDecodedSize(s.size()));
+    size_t written;
+    Result result = decodeStrict<Alphabet>(s.data(), s.size(), reinterpret_cast<unsigned char *>(&out[0]), written);
+    out.resize(written);
+    return result;
+}
+
+template <class Alphabet>
+Result validate(char const * s, size_t len)
+{
+    // Find the first character that is not in the alphabet, and then check the rest starting at its quantum
+    size_t const invalid = detail::findInvalid<Alphabet>(s, len);
+    size_t       p       = (invalid < len) ? invalid - invalid % 4 : len - len % 4;
+    size_t       unused  = 0;
+    return detail::finishStrict<Alphabet>(s, len, p, nullptr, unused);
+}
+
+template <class Alphabet>
+std::string encodeParallel(unsigned char const * bytes, size_t len, unsigned nThreads)
+{
+    std::string ret(encodedSize<Alphabet>(len), 0);
+    ret.resize(encodeParallel<Alphabet>(bytes, len, &ret[0], nThreads));
+    return ret;
+}
+
+template <class Alphabet>
+std::string decodeParallel(std::string const & s, unsigned nThreads)
+{
+    std::string ret(maxDecodedSize(s.size()), 0);
+    ret.resize(decodeParallel<Alphabet>(s.data(), s.size(), reinterpret_cast<unsigned char *>(&ret[0]), nThreads));
+    return ret;
+}
+
+template <class Alphabet>
+size_t encodeParallel(unsigned char const * bytes, size_t len, char * out, unsigned nThreads)
+{
+    unsigned const n = detail::threadCount(len, nThreads);
+
+    // Every piece but the last one is a whole number of groups, so each piece's output position is known in advance
+    size_t const groups          = len / 3;
+    size_t const groupsPerThread = groups / n;
+
+    size_t last = 0;
+    detail::forEachOnThread(n, [=, &last] (unsigned i) {
+        size_t const first = i * groupsPerThread;
+        if (i + 1 < n)
+        {
+            detail::encodeGroups<Alphabet>(bytes + first * 3, groupsPerThread, out + first * 4);
+        }
+        else
+        {
+            BasicEncoder<Alphabet> encoder;
+            size_t written = encoder.update(bytes + first * 3, len - first * 3, out + first * 4);
+            last = written + encoder.finish(out + first * 4 + written);
+        }
+    });
+    return (n - 1) * groupsPerThread * 4 + last;
+}
+
+template <class Alphabet>
+size_t decodeParallel(char const * s, size_t len, unsigned char * out, unsigned nThreads)
+{
+    unsigned const n = detail::threadCount(len, nThreads);
+    if (n <= 1)
+        return decode<Alphabet>(s, len, out);
+
+    size_t const groups          = len / 4;
+    size_t const groupsPerThread = groups / n;
+
+    // Each piece records how many bytes it produced. A piece that produces less than a full piece's worth has found the
+    // end of the input, and the pieces following it are discarded.
+    std::vector<size_t> decoded(n);
+    detail::forEachOnThread(n, [=, &decoded] (unsigned i) {
+        size_t const first = i * groupsPerThread;
+        if (i + 1 < n)
+        {
+            decoded[i] = detail::decodeGroups<Alphabet>(s + first * 4, groupsPerThread, out + first * 3) * 3;
+        }
+        else
+        {
+            BasicDecoder<Alphabet> decoder;
+            size_t written = decoder.update(s + first * 4, len - first * 4, out + first * 3);
+            decoded[i] = written + decoder.finish(out + first * 3 + written);
+        }
+    });
+
+    for (unsigned i = 0; i + 1 < n; ++i)
+    {
+        if (decoded[i] < groupsPerThread * 3)
+        {
+            // The end of the input is in this piece. Finish decoding it serially from where the bulk decoder stopped.
+            size_t const consumed = i * groupsPerThread * 4 + decoded[i] / 3 * 4;
+            size_t       size     = i * groupsPerThread * 3 + decoded[i];
+            BasicDecoder<Alphabet> decoder;
+            size += decoder.update(s + consumed, std::min<size_t>(4, len - consumed), out + size);
+            size += decoder.finish(out + size);
+            return size;
+        }
+    }
+
+    return (n - 1) * groupsPerThread * 3 + decoded[n - 1];
+}
+
+template <class Alphabet>
+size_t BasicEncoder<Alphabet>::update(unsigned char const * bytes, size_t len, char * out)
+{
+    char * const start = out;
+
+    // Complete the quantum carried over from the previous call
+    if (nPending_ > 0)
+    {
+        while (nPending_ < 3 && len > 0)
+        {
+            pending_[nPending_++] = *bytes++;
+            --len;
+        }
+        if (nPending_ < 3)
+            return 0;
+
+        out      += put(pending_, 1, out);
+        nPending_ = 0;
+    }
+
+    size_t const groups = len / 3;
+    out   += put(bytes, groups, out);
+    bytes += groups * 3;
+    len   -= groups * 3;
+
+    // Carry the remainder over to the next call
+    while (len > 0)
+    {
+        pending_[nPending_++] = *bytes++;
+        --len;
+    }
+
+    return out - start;
+}
+
+template <class Alphabet>
+void BasicEncoder<Alphabet>::update(unsigned char const * bytes, size_t len, std::string & out)
+{
+    size_t const size = out.size();
+    out.resize(size + maxOutput((nPending_ + len) / 3 * 4));
+    out.resize(size + update(bytes, len, &out[size]));
+}
+
+template <class Alphabet>
+size_t BasicEncoder<Alphabet>::finish(char * out)
+{
+    size_t n = 0;
+    if (nPending_ > 0)
+    {
+        if (lineLength_ > 0 && column_ == lineLength_)
+        {
+            n = eol_.copy(out, eol_.size());
+        }
+        n += detail::encodeTail<Alphabet>(pending_, nPending_, out + n);
+    }
+
+    nPending_ = 0;
+    column_   = 0;
+    return n;
+}
+
+template <class Alphabet>
+void BasicEncoder<Alphabet>::finish(std::string & out)
+{
+    size_t const size = out.size();
+    out.resize(size + maxOutput(4));
+    out.resize(size + finish(&out[size]));
+}
+
+template <class Alphabet>
+size_t BasicEncoder<Alphabet>::put(unsigned char const * in, size_t groups, char * out)
+{
+    if (lineLength_ == 0)
+    {
+        detail::encodeGroups<Alphabet>(in, groups, out);
+        return groups * 4;
+    }
+
+    // Encode a line's worth of groups at a time. A separator is written only when there is more output to follow it.
+    char * const start = out;
+    while (groups > 0)
+    {
+        if (column_ == lineLength_)
+        {
+            out    += eol_.copy(out, eol_.size());
+            column_ = 0;
+        }
+        size_t const n = std::min(groups, (lineLength_ - column_) / 4);
+        detail::encodeGroups<Alphabet>(in, n, out);
+        in      += n * 3;
+        out     += n * 4;
+        column_ += n * 4;
+        groups  -= n;
+    }
+    return out - start;
+}
+
+template <class Alphabet>
+size_t BasicDecoder<Alphabet>::update(char const * chars, size_t len, unsigned char * out)
+{
+    detail::DecodeTable const & table = detail::Tables<Alphabet>::DECODE;
+    unsigned char * const       start = out;
+
+    while (!done_ && len > 0)
+    {
+        // Decode whole groups in bulk while possible
+        if (nPending_ == 0 && len >= 4)
+        {
+            size_t const groups  = len / 4;
+            size_t const decoded = detail::decodeGroups<Alphabet>(chars, groups, out);
+            out   += decoded * 3;
+            chars += decoded * 4;
+            len   -= decoded * 4;
+            if (decoded == groups)
+                continue;
+        }
+
+        // The bulk decoder stopped at a group containing whitespace or the end of the input, or there is a partial
+        // quantum. Proceed one character at a time until the quantum is complete.
+        do
+        {
+            unsigned char const value = table[*chars++];
+            --len;
+            if (value == detail::SPACE && ignoreWhitespace_)
+                continue;
+            if (value >= 64)
+            {
+                done_ = true;
+                break;
+            }
+            pending_[nPending_++] = value;
+            if (nPending_ == 4)
+            {
+                detail::decodeQuantum(pending_, out);
+                out      += 3;
+                nPending_ = 0;
+            }
+        } while (nPending_ > 0 && len > 0);
+    }
+
+    return out - start;
+}
+
+template <class Alphabet>
+void BasicDecoder<Alphabet>::update(char const * chars, size_t len, std::string & out)
+{
+    size_t const size = out.size();
+    out.resize(size + maxDecodedSize(nPending_ + len));
+    out.resize(size + update(chars, len, reinterpret_cast<unsigned char *>(&out[size])));
+}
+
+template <class Alphabet>
+size_t BasicDecoder<Alphabet>::finish(unsigned char * out)
+{
+    size_t n = 0;
+    if (nPending_ > 1)
+    {
+        for (size_t i = nPending_; i < 4; ++i)
+        {
+            pending_[i] = 0;
+        }
+
+        unsigned char quantum[3];
+        detail::decodeQuantum(pending_, quantum);
+        n = nPending_ - 1;
+        for (size_t i = 0; i < n; ++i)
+        {
+            out[i] = quantum[i];
+        }
+    }
+
+    nPending_ = 0;
+    done_     = false;
+    return n;
+}
+
+template <class Alphabet>
+void BasicDecoder<Alphabet>::finish(std::string & out)
+{
+    size_t const size = out.size();
+    out.resize(size + 2);
+    out.resize(size + finish(reinterpret_cast<unsigned char *>(&out[size])));
+}
+
+// The built-in alphabets are instantiated in Base64.cpp
+extern template class BasicEncoder<Standard>;
+extern template class BasicEncoder<StandardNoPad>;
+extern template class BasicEncoder<Url>;
+extern template class BasicEncoder<UrlNoPad>;
+extern template class BasicDecoder<Standard>;
+extern template class BasicDecoder<StandardNoPad>;
+extern template class BasicDecoder<Url>;
+extern template class BasicDecoder<UrlNoPad>;
 } // namespace Base64
 
 #endif /* BASE64_H_C0CE2A47_D10E_42C9_A27C_C883944E704A */
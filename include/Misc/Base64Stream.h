@@ -0,0 +1,276 @@
+#if !defined(MISC_BASE64STREAM_H_INCLUDED)
+#define MISC_BASE64STREAM_H_INCLUDED
+#pragma once
+
+#include "Base64.h"
+
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace Base64
+{
+//! A stream buffer that encodes the bytes written to it and writes the characters to another stream buffer.
+//!
+//! Encoding is done through fixed internal buffers, so the memory used is constant regardless of the amount of data.
+//! Large writes bypass the internal buffer and are encoded directly from the caller's data. The last partial quantum
+//! and the padding are written when finish() is called or when the buffer is destroyed. For example:
+//! @code
+//!
+//!     Base64::ostreambuf buffer(file.rdbuf());
+//!     std::ostream       out(&buffer);
+//!     out << attachment;
+//!     buffer.finish(); @endcode
+//!
+//! @param  Alphabet    Alphabet and padding policy
+template <class Alphabet = Standard>
+class ostreambuf : public std::streambuf
+{
+public:
+
+    //! Constructor.
+    //!
+    //! @param  target      Stream buffer that receives the encoded characters
+    explicit ostreambuf(std::streambuf * target)
+        : target_(target)
+        , encoded_(encodedSize<Alphabet>(BUFFER_SIZE) + 4)
+    {
+        setp(bytes_, bytes_ + BUFFER_SIZE);
+    }
+
+    //! Constructor.
+    //!
+    //! @param  target      Stream buffer that receives the encoded characters
+    //! @param  lineLength  Maximum number of characters in a line. It is rounded down to a multiple of 4, and if it
+    //!                     is less than 4, the output is not broken into lines.
+    //! @param  eol         Line separator. It is inserted between lines, but not after the last line.
+    ostreambuf(std::streambuf * target, size_t lineLength, std::string const & eol = "\r\n")
+        : target_(target)
+        , encoder_(lineLength, eol)
+        , encoded_(encodedSize<Alphabet>(BUFFER_SIZE, lineLength, eol.size()) + 4 + 2 * eol.size())
+    {
+        setp(bytes_, bytes_ + BUFFER_SIZE);
+    }
+
+    //! Destructor. The remaining bytes are encoded if finish() has not been called.
+    ~ostreambuf() override
+    {
+        finish();
+    }
+
+    //! Encodes the remaining bytes and writes the padding. Further output begins a new encoding.
+    //!
+    //! @return     true if all characters were written to the target
+    bool finish()
+    {
+        bool ok = flush();
+        size_t const n = encoder_.finish(encoded_.data());
+        ok = write(encoded_.data(), n) && ok;
+        return ok;
+    }
+
+protected:
+
+    //! @name Overrides std::streambuf
+    //@{
+
+    int_type overflow(int_type ch) override
+    {
+        if (!flush())
+            return traits_type::eof();
+        if (!traits_type::eq_int_type(ch, traits_type::eof()))
+        {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(char const * s, std::streamsize n) override
+    {
+        // Small writes go through the buffer
+        if (n < static_cast<std::streamsize>(epptr() - pptr()))
+        {
+            traits_type::copy(pptr(), s, static_cast<size_t>(n));
+            pbump(static_cast<int>(n));
+            return n;
+        }
+
+        // Large writes are encoded directly from the caller's data
+        if (!flush())
+            return 0;
+        std::streamsize written = 0;
+        while (written < n)
+        {
+            size_t const chunk = static_cast<size_t>(std::min<std::streamsize>(n - written, BUFFER_SIZE));
+            if (!encode(reinterpret_cast<unsigned char const *>(s + written), chunk))
+                break;
+            written += chunk;
+        }
+        return written;
+    }
+
+    int sync() override
+    {
+        return (flush() && target_->pubsync() != -1) ? 0 : -1;
+    }
+
+    //@}
+
+private:
+
+    // Size of the put area in bytes. It is a multiple of 3 so that a full buffer leaves nothing in the encoder.
+    static size_t constexpr BUFFER_SIZE = 3 * 1024;
+
+    // non-copyable
+    ostreambuf(ostreambuf const &) = delete;
+    ostreambuf & operator =(ostreambuf const &) = delete;
+
+    // Encodes the contents of the put area
+    bool flush()
+    {
+        size_t const n = pptr() - pbase();
+        setp(bytes_, bytes_ + BUFFER_SIZE);
+        return encode(reinterpret_cast<unsigned char const *>(bytes_), n);
+    }
+
+    // Encodes up to BUFFER_SIZE bytes and writes the result to the target
+    bool encode(unsigned char const * bytes, size_t len)
+    {
+        return write(encoded_.data(), encoder_.update(bytes, len, encoded_.data()));
+    }
+
+    bool write(char const * chars, size_t n)
+    {
+        return target_->sputn(chars, static_cast<std::streamsize>(n)) == static_cast<std::streamsize>(n);
+    }
+
+    std::streambuf * target_;           // Destination of the encoded characters
+    BasicEncoder<Alphabet> encoder_;    // Encoder state carried between writes
+    char bytes_[BUFFER_SIZE];           // Put area
+    std::vector<char> encoded_;         // Encoded characters waiting to be written to the target
+};
+
+//! A stream buffer that reads characters from another stream buffer and provides the decoded bytes.
+//!
+//! Decoding is done through fixed internal buffers, so the memory used is constant regardless of the amount of data.
+//! Large reads bypass the internal buffer and are decoded directly into the caller's buffer. As with decode(), the first
+//! '=' or non-base64 character ends the input. For example:
+//! @code
+//!
+//!     Base64::istreambuf buffer(file.rdbuf(), true);
+//!     std::istream       in(&buffer);
+//!     in.read(data, size); @endcode
+//!
+//! @param  Alphabet    Alphabet and padding policy
+template <class Alphabet = Standard>
+class istreambuf : public std::streambuf
+{
+public:
+
+    //! Constructor.
+    //!
+    //! @param  source              Stream buffer that provides the encoded characters
+    //! @param  ignoreWhitespace    If true, spaces, tabs and line breaks are skipped rather than ending the input
+    explicit istreambuf(std::streambuf * source, bool ignoreWhitespace = false)
+        : source_(source)
+        , decoder_(ignoreWhitespace)
+    {
+        setg(bytes_, bytes_, bytes_);
+    }
+
+protected:
+
+    //! @name Overrides std::streambuf
+    //@{
+
+    int_type underflow() override
+    {
+        if (gptr() == egptr())
+        {
+            size_t const n = decode(reinterpret_cast<unsigned char *>(bytes_), BUFFER_SIZE);
+            setg(bytes_, bytes_, bytes_ + n);
+            if (n == 0)
+                return traits_type::eof();
+        }
+        return traits_type::to_int_type(*gptr());
+    }
+
+    std::streamsize xsgetn(char * s, std::streamsize n) override
+    {
+        // Take what is in the buffer first
+        std::streamsize got = std::min<std::streamsize>(n, egptr() - gptr());
+        traits_type::copy(s, gptr(), static_cast<size_t>(got));
+        gbump(static_cast<int>(got));
+
+        // Decode the rest directly into the caller's buffer if it is large, or through the buffer if it is not
+        while (got < n)
+        {
+            std::streamsize const remaining = n - got;
+            if (remaining >= static_cast<std::streamsize>(BUFFER_SIZE))
+            {
+                size_t const decoded = decode(reinterpret_cast<unsigned char *>(s + got), BUFFER_SIZE);
+                if (decoded == 0)
+                    break;
+                got += decoded;
+            }
+            else
+            {
+                if (traits_type::eq_int_type(underflow(), traits_type::eof()))
+                    break;
+                std::streamsize const chunk = std::min<std::streamsize>(remaining, egptr() - gptr());
+                traits_type::copy(s + got, gptr(), static_cast<size_t>(chunk));
+                gbump(static_cast<int>(chunk));
+                got += chunk;
+            }
+        }
+        return got;
+    }
+
+    //@}
+
+private:
+
+    // Size of the get area in bytes. It is a multiple of 3 so that a full read of characters fills it exactly.
+    static size_t constexpr BUFFER_SIZE = 3 * 1024;
+
+    // non-copyable
+    istreambuf(istreambuf const &) = delete;
+    istreambuf & operator =(istreambuf const &) = delete;
+
+    // Reads characters from the source and decodes them into out, which has room for size bytes (a multiple of 3).
+    // Returns the number of bytes decoded, which is 0 only at the end of the input.
+    size_t decode(unsigned char * out, size_t size)
+    {
+        // Leave room for the bytes decoded from characters carried over in the decoder
+        size_t const maxChars = size / 3 * 4 - 4;
+        while (!finished_)
+        {
+            std::streamsize const got = decoder_.done() ? 0 : source_->sgetn(chars_, static_cast<std::streamsize>(maxChars));
+            size_t n;
+            if (got > 0)
+            {
+                n = decoder_.update(chars_, static_cast<size_t>(got), out);
+            }
+            else
+            {
+                n         = decoder_.finish(out);
+                finished_ = true;
+            }
+            if (n > 0)
+                return n;
+        }
+        return 0;
+    }
+
+    std::streambuf * source_;           // Source of the encoded characters
+    BasicDecoder<Alphabet> decoder_;    // Decoder state carried between reads
+    bool finished_ = false;             // True if the end of the input has been reached
+    char chars_[BUFFER_SIZE / 3 * 4];   // Characters read from the source
+    char bytes_[BUFFER_SIZE];           // Get area
+};
+} // namespace Base64
+
+#endif // !defined(MISC_BASE64STREAM_H_INCLUDED)
@@ -2,26 +2,67 @@
 #define MISC_COMMANDLINELIST_H_INCLUDED
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 //! Parses an array of pointers to strings and or a string with whitespace into an array of tokens.
 //!
-//! Standard command line wildcards are supported.
+//! Standard command line wildcards are supported. On POSIX systems, a "**" component matches any number of directories,
+//! so <tt>src/**/*.cpp</tt> matches every .cpp file in the tree below src.
+//!
+//! An arg of the form <tt>@file</tt> is replaced by the args in the file, which are parsed with the same rules as a
+//! command line, and may themselves include response files. An <tt>@file</tt> arg that cannot be read, or that refers
+//! to a file already being read, is added as is.
+//!
+//! The tokens are stored contiguously in an arena owned by the list, and are accessed as views into it. Tokens read
+//! from a response file are views into a copy-on-write mapping of the file, so large files are not copied. Each token is
+//! followed by a 0, so <tt>args()[i].data()</tt> can be passed to functions expecting a C string.
+//!
+//! Expanding every wildcard up front can produce millions of args before the first one is used. Instead, the list can
+//! be constructed without expanding wildcards and then iterated with expansions(), which expands each arg as it is
+//! reached and streams the matching paths. For example:
+//! @code
+//!
+//!     CommandLineList const list(argc, argv, false);
+//!     for (std::string_view path : list.expansions())
+//!         process(path); @endcode
 class CommandLineList
 {
 public:
 
+    class ExpandingIterator;
+    class Expansions;
+
     //! Constructor.
     //!
-    //! @param  commandLine     Command line as a single string
-    CommandLineList(char const * commandLine);
+    //! @param  commandLine         Command line as a single string
+    //! @param  expandWildcards     If false, args with wildcards are added as is, to be expanded by expansions()
+    CommandLineList(char const * commandLine, bool expandWildcards = true);
 
     //! Constructor.
     //!
-    //! @param  argc    argc parameter
-    //! @param  argv    argv parameter
-    CommandLineList(int argc, char ** argv);
+    //! @param  argc                argc parameter
+    //! @param  argv                argv parameter
+    //! @param  expandWildcards     If false, args with wildcards are added as is, to be expanded by expansions()
+    CommandLineList(int argc, char ** argv, bool expandWildcards = true);
+
+    //! Copy constructor.
+    CommandLineList(CommandLineList const & rhs);
+
+    //! Move constructor.
+    CommandLineList(CommandLineList && rhs) noexcept;
+
+    //! Destructor.
+    ~CommandLineList();
+
+    //! Assignment operator.
+    CommandLineList & operator =(CommandLineList rhs);
 
     //! Expands an arg and add the result to the list.
     //!
@@ -30,14 +71,153 @@ public:
     //! @param  arg     argument string
     void include(char const * arg);
 
+    //! Expands a list of args and adds the results to the list, in order.
+    //!
+    //! This is faster than including the args one at a time when many patterns refer to the same directories, because
+    //! each directory is read only once and the directories are read in parallel. The results are the same.
+    //!
+    //! @param  args    argument strings
+    void include(std::vector<std::string_view> const & args);
+
+    //! Removes duplicate args, keeping the first occurrence of each.
+    //!
+    //! Args are compared as paths, ignoring "." components and repeated or trailing separators, so <tt>a/./b</tt> and
+    //! <tt>a//b</tt> are duplicates of <tt>a/b</tt>. ".." components are not resolved, and the file system is not
+    //! accessed. The args are found with an open-addressing hash table of 32-bit indexes and hashes. Its capacity is a
+    //! power of 2 of at least 1.5 slots per arg, so it temporarily uses 12 to 24 bytes per arg. The remaining views
+    //! still refer to the original storage.
+    //!
+    //! @param  sort    If true, the remaining args are sorted. Otherwise, they remain in their original order.
+    void removeDuplicates(bool sort = false);
+
     //! Returns the number of parsed command line tokens.
     size_t argc() const { return args_.size(); }
 
     //! Returns the parsed command line tokens.
-    std::vector<std::string> args() const { return args_; }
+    //!
+    //! @note   The views are valid as long as the list exists. Moving the list does not invalidate them.
+    std::vector<std::string_view> const & args() const { return args_; }
+
+    //! Returns a range over the args in which wildcards are expanded lazily.
+    //!
+    //! Each arg with wildcards is replaced by the paths that match it, in the order they are found. Unlike the
+    //! expansions done by the constructors, the paths are not sorted, because sorting would require reading them all
+    //! first. The memory used is proportional to the depth of the directories read, not the number of matches.
+    //!
+    //! @note   The list must outlive the range and its iterators.
+    Expansions expansions() const;
+
+private:
+
+    friend class ExpandingIterator;
+
+    // Minimum size of an arena block
+    static size_t constexpr BLOCK_SIZE = 64 * 1024;
+
+    // Identifies a file independently of its path
+    using FileId = std::pair<uint64_t, uint64_t>;
+
+    class MappedFile;
+
+    // Returns a hash of a path that is the same for paths that are equal according to pathEqual()
+    static uint32_t pathHash(std::string_view path);
+
+    // Returns true if two paths are the same, ignoring "." components and repeated or trailing separators
+    static bool pathEqual(std::string_view a, std::string_view b);
+
+    // Splits text into tokens in place, terminating each token that is followed by a delimiter
+    static void tokenize(char * begin, char * end, std::vector<std::string_view> & tokens);
+
+    // Appends args to tokens, replacing response files with their contents. open identifies the files being read.
+    void readResponseFiles(std::vector<std::string_view> const & args,
+                           std::vector<std::string_view> &       tokens,
+                           std::vector<FileId> &                 open);
+
+    // Starts a new arena block with room for exactly size characters
+    void reserve(size_t size);
+
+    // Reserves space for size characters in the arena and returns a pointer to it
+    char * allocate(size_t size);
+
+    // Copies a string and its terminator into the arena and returns a view of the copy
+    std::string_view store(std::string_view s);
+
+    // Adds tokens stored in the arena, replacing response files and expanding the tokens that contain wildcards
+    void expand(std::vector<std::string_view> const & args, bool expandWildcards = true);
+
+    // Adds a token stored in the arena, expanding it if it contains wildcards
+    void expand(std::string_view arg);
+
+    std::vector<std::unique_ptr<MappedFile>> files_;                // Response files. Views into them remain valid.
+    std::vector<std::unique_ptr<char[]>>     blocks_;               // Arena blocks. Views into them remain valid.
+    char *                                   next_      = nullptr;  // Next free character in the current block
+    size_t                                   available_ = 0;        // Number of free characters in the current block
+    std::vector<std::string_view>            args_;                 // Tokens
+};
+
+//! An input iterator over the args of a CommandLineList that expands wildcards as it advances.
+//!
+//! Copies of an iterator share the state of the expansion, so advancing one advances them all.
+//!
+//! @note   A path is only valid until the iterator is advanced.
+class CommandLineList::ExpandingIterator
+{
+public:
+
+    using iterator_category = std::input_iterator_tag;
+    using value_type        = std::string_view;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = std::string_view const *;
+    using reference         = std::string_view const &;
+
+    //! Constructor. The iterator is at the end.
+    ExpandingIterator() = default;
+
+    reference operator *() const { return current_; }
+    pointer operator ->() const { return &current_; }
+
+    //! Advances to the next arg or path.
+    ExpandingIterator & operator ++();
+
+    bool operator ==(ExpandingIterator const & rhs) const { return walker_ == rhs.walker_; }
+    bool operator !=(ExpandingIterator const & rhs) const { return walker_ != rhs.walker_; }
+
+private:
+
+    friend class Expansions;
+
+    class Walker;
+
+    explicit ExpandingIterator(CommandLineList const & list);
+
+    std::shared_ptr<Walker> walker_;    // State of the expansion, or null at the end
+    std::string_view        current_;   // Current arg or path
+};
+
+//! A range over the args of a CommandLineList in which wildcards are expanded lazily. See CommandLineList::expansions().
+class CommandLineList::Expansions
+{
+public:
+
+    //! Constructor.
+    //!
+    //! @param  list    List to expand
+    explicit Expansions(CommandLineList const & list) : list_(list) {}
+
+    //! Starts expanding the args.
+    ExpandingIterator begin() const { return ExpandingIterator(list_); }
+
+    //! Returns the end of the range.
+    ExpandingIterator end() const { return ExpandingIterator(); }
 
 private:
-    std::vector<std::string> args_;
+
+    CommandLineList const & list_;
 };
 
+inline CommandLineList::Expansions CommandLineList::expansions() const
+{
+    return Expansions(*this);
+}
+
 #endif // !defined(MISC_COMMANDLINELIST_H_INCLUDED)
@@ -0,0 +1,90 @@
+#if !defined(MISC_GLOBPATTERN_H_INCLUDED)
+#define MISC_GLOBPATTERN_H_INCLUDED
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//! A compiled wildcard pattern that matches paths without touching the file system.
+//!
+//! The syntax and semantics are the same as the wildcards expanded by CommandLineList:
+//!
+//!     - <tt>*</tt> matches any number of characters other than '/'
+//!     - <tt>?</tt> matches any character other than '/'
+//!     - <tt>[abc]</tt>, <tt>[a-z]</tt> match a character in the set, and <tt>[!abc]</tt> or <tt>[^abc]</tt> match a
+//!       character not in the set. The set never matches '/'.
+//!     - A <tt>**</tt> component matches any number of directories, including none. A trailing <tt>**</tt> matches
+//!       every path below its directory.
+//!     - A backslash matches the character following it literally.
+//!
+//! As with glob(), a '.' at the start of a path component is only matched by a '.' in the pattern. Named character
+//! classes such as <tt>[[:alpha:]]</tt> are not supported.
+//!
+//! The pattern is compiled once, so matching does no allocation and no parsing. Paths that do not begin with the
+//! literal prefix or end with the literal suffix of the pattern are rejected without running the matcher, and the
+//! literal following a '*' is found with memchr. For example:
+//! @code
+//!
+//!     GlobPattern const pattern("src/**/*.cpp");
+//!     for (auto const & path : manifest)
+//!     {
+//!         if (pattern.matches(path))
+//!             compile(path);
+//!     } @endcode
+
+class GlobPattern
+{
+public:
+
+    //! Constructor.
+    //!
+    //! @param  pattern     Wildcard pattern. Components are separated by '/'.
+    explicit GlobPattern(std::string_view pattern);
+
+    //! Returns true if the path matches the pattern.
+    bool matches(std::string_view path) const;
+
+    //! Returns the literal characters at the start of the pattern, which every matching path begins with.
+    std::string const & prefix() const { return prefix_; }
+
+    //! Returns true if the pattern has no wildcards, in which case it only matches prefix().
+    bool isLiteral() const { return literal_; }
+
+    //! Returns true if the string contains any of the wildcard characters '*', '?' or '['.
+    static bool hasWildcards(std::string_view s);
+
+private:
+
+    // An element of a component pattern
+    struct Element
+    {
+        enum Op : uint8_t { LITERAL, ANY, STAR, SET };
+        Op       op;
+        uint32_t offset;    // LITERAL: offset of the characters in literals_. SET: index of the set in sets_.
+        uint32_t size;      // LITERAL: number of characters
+    };
+
+    // The pattern for a path component, or "**"
+    struct Component
+    {
+        uint32_t first;     // Index of the first element
+        uint32_t last;      // Index past the last element
+        bool     recursive; // True if the component is "**"
+    };
+
+    // Returns true if the component [begin, end) of a path matches a component of the pattern
+    bool matches(Component const & component, char const * begin, char const * end) const;
+
+    std::vector<Element>          elements_;
+    std::vector<Component>        components_;
+    std::string                   literals_;    // Characters of the literal elements
+    std::vector<std::bitset<256>> sets_;        // Character sets
+    std::string                   prefix_;      // Literal characters at the start of the pattern
+    std::string                   suffix_;      // Literal characters at the end of the last component
+    bool                          literal_;     // True if the pattern has no wildcards
+};
+
+#endif // !defined(MISC_GLOBPATTERN_H_INCLUDED)
@@ -2,33 +2,69 @@
 #define MISC_PATHNAME_H_INCLUDED
 #pragma once
 
-#include <locale>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
+
+//! A table that maps each character to the character it is equivalent to in a path name.
+//!
+//! ASCII lowercase letters map to uppercase and '\' maps to '/'. Every other character maps to itself.
+
+struct path_char_fold_table
+{
+    constexpr path_char_fold_table()
+        : table()
+    {
+        for (int c = 0; c < 256; ++c)
+        {
+            table[c] = static_cast<unsigned char>((c >= 'a' && c <= 'z') ? c - 'a' + 'A' : (c == '\\') ? '/' : c);
+        }
+    }
+
+    unsigned char table[256];
+};
 
 //! A variation of std::char_traits for characters in a path name.
 //!
 //! The difference between these traits and <tt>std::char_traits< char ></tt> is that comparisons are
 //! case-independent, and '\' and '/' are equivalent. This struct is used by the class PathName
+//!
+//! Characters are compared by their folded values (see path_char_fold_table) as unsigned bytes, so the ordering is
+//! consistent with equality and does not depend on the locale. compare() and find() process 16 or 32 characters at a
+//! time where SSE2 or AVX2 is available.
+//!
+//! compare() and hash() also fold UTF-8 characters by Unicode simple case folding, limited to the foldings that do not
+//! change the length of the encoding, so "Ärger" and "äRGER" are equal but "STRASSE" and "straße" are not. Blocks of
+//! ASCII characters take the table-driven path, and only runs of non-ASCII characters are decoded. Invalid UTF-8
+//! sequences are compared byte by byte. eq(), lt() and find() work on single bytes, so they fold only ASCII letters.
+//!
+//! compare() reads only the characters it is given, so a sequence cut by its count is incomplete and compared byte by
+//! byte, as fold() and hash() treat an incomplete sequence at the end of a string. Folding keeps the length of each
+//! sequence, so for valid UTF-8 the order is that of the folded strings, as used by PathName::sort(). Strings that are
+//! not valid UTF-8 may be ordered differently by the two.
 
 struct char_traits_path_char : public std::char_traits<char>
 {
     //! @name Overrides char_traits<char>
     //@{
 
-    static bool __cdecl eq(char _Left, char _Right)
+    static constexpr bool eq(char _Left, char _Right)
     {
-        return _Left == _Right ||
-               (is_slash(_Left) && is_slash(_Right)) ||
-               std::toupper(_Left, std::locale()) == std::toupper(_Right, std::locale());
+        return fold(_Left) == fold(_Right);
     }
 
-    static bool __cdecl lt(char _Left, char _Right)
+    static constexpr bool lt(char _Left, char _Right)
     {
-        return (!is_slash(_Left) || !is_slash(_Right)) &&
-               std::toupper(_Left, std::locale()) < std::toupper(_Right, std::locale());
+        return fold(_Left) < fold(_Right);
     }
 
-    static bool __cdecl eq_int_type(const int_type & _Left, const int_type & _Right)
+    static bool eq_int_type(const int_type & _Left, const int_type & _Right)
     {
         if (_Left == _Right)
             return true;
@@ -39,49 +75,50 @@ struct char_traits_path_char : public std::char_traits<char>
         return eq(to_char_type(_Left), to_char_type(_Right));
     }
 
-    static int __cdecl compare(const char * _First1, const char * _First2, size_t _Count)
-    {
-        while (_Count > 0 && eq(*_First1, *_First2))
-        {
-            --_Count;
-            ++_First1;
-            ++_First2;
-        }
+    static int compare(const char * _First1, const char * _First2, size_t _Count);
 
-        if (_Count <= 0)
-            return 0;
-        else if (lt(*_First1, *_First2))
-            return -1;
-        else
-            return +1;
-    }
+    static const char * find(const char * _First, size_t _Count, char _Ch);
 
-    static const char * __cdecl find(const char * _First, size_t _Count, char _Ch)
-    {
-        while (_Count > 0 && !eq(*_First, _Ch))
-        {
-            --_Count;
-            ++_First;
-        }
+    //@}
 
-        if (_Count <= 0)
-            return 0;
-        else
-            return _First;
-    }
+    //! Returns a hash of a string that is the same for all strings that compare equal with these traits. It does not
+    //! allocate.
+    //!
+    //! @param	_First      string to hash
+    //! @param	_Count      number of characters in the string
+    static uint64_t hash(const char * _First, size_t _Count);
 
-    //@}
+    //! Folds a string as compare() and hash() do. The folded string has the same length.
+    //!
+    //! @param	_First      string to fold
+    //! @param	_Count      number of characters in the string
+    //! @param	_Dest       folded characters. It may be the same as _First.
+    static void fold(const char * _First, size_t _Count, char * _Dest);
+
+    //! Returns the character that a character is equivalent to.
+    //!
+    //! @param	c	character to fold
+    static constexpr unsigned char fold(char c)
+    {
+        return FOLD.table[static_cast<unsigned char>(c)];
+    }
 
     //! Returns true if the character is a slash or backslash
     //!
     //!
     //! @param	c	character to test
-    static bool is_slash(char c)
+    static constexpr bool is_slash(char c)
     {
         return c == '\\' || c == '/';
     }
+
+    //! The table used by fold()
+    static constexpr path_char_fold_table FOLD {};
 };
 
+//! A view of a path name, with the same comparisons as PathName.
+using PathNameView = std::basic_string_view<char, char_traits_path_char>;
+
 //! A string usable for path names.
 //!
 //!
@@ -90,6 +127,353 @@ struct char_traits_path_char : public std::char_traits<char>
 
 class PathName : public std::basic_string<char, char_traits_path_char>
 {
+public:
+    using std::basic_string<char, char_traits_path_char>::basic_string;
+
+    //! Normalizes the path in place. See normalize(char *, size_t).
+    PathName & normalize()
+    {
+        resize(normalize(&(*this)[0], size()));
+        return *this;
+    }
+
+    //! Normalizes a path in place, in one pass and without allocating, and returns its new size.
+    //!
+    //! Each separator becomes a single '/', and empty and "." components are removed. A ".." component removes the
+    //! component before it, unless it is at the start of a relative path or follows another ".." that could not be
+    //! removed, in which case it is kept. A ".." at the root of an absolute path is removed. The root is a leading
+    //! separator, a drive such as "C:" and the separator after it, or the "//server/share" of a UNC path, and it is
+    //! never removed. A path that becomes empty becomes ".", unless it was empty to begin with. The case of the
+    //! characters is not changed and the file system is not accessed, so symbolic links are not resolved.
+    //!
+    //! @param  path    Characters of the path, which are overwritten
+    //! @param  size    Number of characters in the path
+    static size_t normalize(char * path, size_t size);
+
+    //! Sorts path names in the order given by char_traits_path_char::compare(), the same order as std::sort. For paths
+    //! that are not valid UTF-8, the order is that of the folded paths (see char_traits_path_char).
+    //!
+    //! The paths are sorted by their folded characters 8 at a time, packed into integers, so most comparisons are
+    //! integer comparisons. Paths whose first 8 characters are equal are then sorted by their next 8 characters, and
+    //! so on, so long common prefixes such as a shared directory cost one integer comparison per 8 characters. Paths
+    //! with non-ASCII characters are folded into a copy first. Paths that compare equal keep their original order.
+    //!
+    //! @param  paths   Paths to sort
+    static void sort(std::vector<PathName> & paths);
+
+    //! Sorts path name views. See sort(std::vector<PathName> &).
+    //!
+    //! @param  paths   Paths to sort
+    static void sort(std::vector<PathNameView> & paths);
+};
+
+//! A range over the components of a path, which are views of the path and are never copied.
+//!
+//! Both '/' and '\' are separators, and empty components are skipped, so <tt>/a//b\\c/</tt> has the components
+//! "a", "b" and "c". "." and ".." components are returned as they are. For example:
+//! @code
+//!
+//!     for (std::string_view component : PathComponents(path))
+//!         resolve(component); @endcode
+
+class PathComponents
+{
+public:
+
+    //! A forward iterator over the components of a path.
+    class iterator
+    {
+    public:
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = std::string_view;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = std::string_view const *;
+        using reference         = std::string_view const &;
+
+        //! Constructor. The iterator is at the end.
+        iterator() = default;
+
+        reference operator *() const { return component_; }
+        pointer operator ->() const { return &component_; }
+
+        //! Advances to the next component.
+        iterator & operator ++()
+        {
+            next(component_.data() + component_.size());
+            return *this;
+        }
+
+        iterator operator ++(int)
+        {
+            iterator const previous = *this;
+            ++(*this);
+            return previous;
+        }
+
+        bool operator ==(iterator const & rhs) const { return component_.data() == rhs.component_.data(); }
+        bool operator !=(iterator const & rhs) const { return component_.data() != rhs.component_.data(); }
+
+    private:
+
+        friend class PathComponents;
+
+        iterator(char const * p, char const * end)
+            : end_(end)
+        {
+            next(p);
+        }
+
+        // Finds the first component at or after p, or moves to the end
+        void next(char const * p)
+        {
+            while (p < end_ && char_traits_path_char::is_slash(*p))
+            {
+                ++p;
+            }
+            char const * q = p;
+            while (q < end_ && !char_traits_path_char::is_slash(*q))
+            {
+                ++q;
+            }
+            component_ = (p < end_) ? std::string_view(p, static_cast<size_t>(q - p)) : std::string_view();
+        }
+
+        char const *     end_ = nullptr;    // End of the path
+        std::string_view component_;        // Current component. The data is null at the end.
+    };
+
+    //! Constructor.
+    //!
+    //! @param  path    Path to split. It must outlive the range and its iterators.
+    explicit PathComponents(std::string_view path) : path_(path) {}
+
+    //! Constructor.
+    //!
+    //! @param  path    Path to split. It must outlive the range and its iterators.
+    explicit PathComponents(PathNameView path) : path_(path.data(), path.size()) {}
+
+    //! Constructor.
+    //!
+    //! @param  path    Path to split. It must outlive the range and its iterators.
+    explicit PathComponents(char const * path) : path_(path) {}
+
+    //! Returns an iterator at the first component.
+    iterator begin() const { return iterator(path_.data(), path_.data() + path_.size()); }
+
+    //! Returns the end of the range.
+    iterator end() const { return iterator(); }
+
+private:
+
+    std::string_view path_;
+};
+
+//! A path name stored inline in a fixed-size buffer, so it is never allocated on the heap.
+//!
+//! The comparisons are the same as PathName's, and the characters are always followed by a 0. A FixedPathName
+//! converts implicitly to a PathNameView and explicitly from a PathName or a PathNameView, so conversion in either
+//! direction is a single copy. An operation that would make the path longer than N characters throws
+//! std::length_error, as std::string does when it exceeds max_size(). For example:
+//! @code
+//!
+//!     FixedPathName<> path(root);
+//!     path.append("/").append(relative).normalize();
+//!     if (manifest.contains(path))
+//!         ... @endcode
+//!
+//! @param  N   Maximum number of characters
+
+template <size_t N = 256>
+class FixedPathName
+{
+public:
+
+    using traits_type     = char_traits_path_char;
+    using value_type      = char;
+    using size_type       = size_t;
+    using iterator        = char *;
+    using const_iterator  = char const *;
+
+    //! Constructor. The path is empty.
+    FixedPathName() { data_[0] = 0; }
+
+    //! Constructor.
+    //!
+    //! @param  path    Characters to copy
+    explicit FixedPathName(PathNameView path) { assign(path); }
+
+    //! Constructor.
+    //!
+    //! @param  path    Characters to copy
+    explicit FixedPathName(PathName const & path) { assign(path); }
+
+    //! Constructor.
+    //!
+    //! @param  path    Characters to copy
+    explicit FixedPathName(char const * path) { assign(path); }
+
+    //! Copy constructor. Only the characters in use are copied.
+    FixedPathName(FixedPathName const & rhs) { assign(rhs.view()); }
+
+    //! Assignment operator. Only the characters in use are copied.
+    FixedPathName & operator =(FixedPathName const & rhs) { return assign(rhs.view()); }
+
+    //! Returns the path as a view.
+    operator PathNameView() const { return PathNameView(data_, size_); }
+
+    //! Returns the path as a view.
+    PathNameView view() const { return PathNameView(data_, size_); }
+
+    //! Returns a PathName with the same characters.
+    PathName str() const { return PathName(data_, size_); }
+
+    char const * data() const { return data_; }
+    char * data() { return data_; }
+    char const * c_str() const { return data_; }
+    size_t size() const { return size_; }
+    size_t length() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    static constexpr size_t capacity() { return N; }
+    static constexpr size_t max_size() { return N; }
+
+    char & operator [](size_t i) { return data_[i]; }
+    char operator [](size_t i) const { return data_[i]; }
+    char & back() { return data_[size_ - 1]; }
+    char back() const { return data_[size_ - 1]; }
+
+    iterator begin() { return data_; }
+    iterator end() { return data_ + size_; }
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + size_; }
+
+    //! Removes all characters.
+    void clear()
+    {
+        size_    = 0;
+        data_[0] = 0;
+    }
+
+    //! Changes the number of characters. Added characters are set to c.
+    void resize(size_t size, char c = 0)
+    {
+        check(size);
+        if (size > size_)
+            memset(data_ + size_, c, size - size_);
+        size_        = size;
+        data_[size_] = 0;
+    }
+
+    //! Replaces the characters.
+    FixedPathName & assign(PathNameView path)
+    {
+        check(path.size());
+        memmove(data_, path.data(), path.size());
+        size_        = path.size();
+        data_[size_] = 0;
+        return *this;
+    }
+
+    //! Appends characters.
+    FixedPathName & append(PathNameView path)
+    {
+        check(size_ + path.size());
+        memmove(data_ + size_, path.data(), path.size());
+        size_       += path.size();
+        data_[size_] = 0;
+        return *this;
+    }
+
+    FixedPathName & operator +=(PathNameView path) { return append(path); }
+    FixedPathName & operator +=(char c)
+    {
+        push_back(c);
+        return *this;
+    }
+
+    void push_back(char c)
+    {
+        check(size_ + 1);
+        data_[size_++] = c;
+        data_[size_]   = 0;
+    }
+
+    void pop_back() { data_[--size_] = 0; }
+
+    //! Normalizes the path in place. See PathName::normalize(char *, size_t).
+    FixedPathName & normalize()
+    {
+        size_        = PathName::normalize(data_, size_);
+        data_[size_] = 0;
+        return *this;
+    }
+
+    //! Compares with another path, as PathName::compare() does.
+    int compare(PathNameView rhs) const { return view().compare(rhs); }
+
+    friend bool operator ==(FixedPathName const & a, FixedPathName const & b) { return a.view() == b.view(); }
+    friend bool operator ==(FixedPathName const & a, PathNameView b) { return a.view() == b; }
+    friend bool operator ==(PathNameView a, FixedPathName const & b) { return a == b.view(); }
+    friend bool operator !=(FixedPathName const & a, FixedPathName const & b) { return a.view() != b.view(); }
+    friend bool operator !=(FixedPathName const & a, PathNameView b) { return a.view() != b; }
+    friend bool operator !=(PathNameView a, FixedPathName const & b) { return a != b.view(); }
+    friend bool operator <(FixedPathName const & a, FixedPathName const & b) { return a.view() < b.view(); }
+    friend bool operator <(FixedPathName const & a, PathNameView b) { return a.view() < b; }
+    friend bool operator <(PathNameView a, FixedPathName const & b) { return a < b.view(); }
+    friend bool operator >(FixedPathName const & a, FixedPathName const & b) { return a.view() > b.view(); }
+    friend bool operator >(FixedPathName const & a, PathNameView b) { return a.view() > b; }
+    friend bool operator >(PathNameView a, FixedPathName const & b) { return a > b.view(); }
+    friend bool operator <=(FixedPathName const & a, FixedPathName const & b) { return a.view() <= b.view(); }
+    friend bool operator <=(FixedPathName const & a, PathNameView b) { return a.view() <= b; }
+    friend bool operator <=(PathNameView a, FixedPathName const & b) { return a <= b.view(); }
+    friend bool operator >=(FixedPathName const & a, FixedPathName const & b) { return a.view() >= b.view(); }
+    friend bool operator >=(FixedPathName const & a, PathNameView b) { return a.view() >= b; }
+    friend bool operator >=(PathNameView a, FixedPathName const & b) { return a >= b.view(); }
+
+private:
+
+    // Throws std::length_error if size is more than N
+    static void check(size_t size)
+    {
+        if (size > N)
+            throw std::length_error("FixedPathName: the path is too long");
+    }
+
+    size_t size_ = 0;       // Number of characters
+    char   data_[N + 1];    // Characters, followed by a 0
+};
+
+namespace std
+{
+//! Hashes a PathName so that path names that compare equal have the same hash.
+template <>
+struct hash<PathName>
+{
+    size_t operator ()(PathName const & path) const noexcept
+    {
+        return static_cast<size_t>(char_traits_path_char::hash(path.data(), path.size()));
+    }
+};
+
+//! Hashes a PathNameView so that path names that compare equal have the same hash.
+template <>
+struct hash<PathNameView>
+{
+    size_t operator ()(PathNameView path) const noexcept
+    {
+        return static_cast<size_t>(char_traits_path_char::hash(path.data(), path.size()));
+    }
+};
+
+//! Hashes a FixedPathName so that it has the same hash as a PathName that compares equal.
+template <size_t N>
+struct hash<FixedPathName<N>>
+{
+    size_t operator ()(FixedPathName<N> const & path) const noexcept
+    {
+        return static_cast<size_t>(char_traits_path_char::hash(path.data(), path.size()));
+    }
 };
+} // namespace std
 
 #endif // !defined(MISC_PATHNAME_H_INCLUDED)
@@ -0,0 +1,280 @@
+#if !defined(MISC_PATHNAMEMAP_H_INCLUDED)
+#define MISC_PATHNAMEMAP_H_INCLUDED
+#pragma once
+
+#include "PathName.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+//! An open-addressing hash table of path names, the common part of PathNameSet and PathNameMap.
+//!
+//! The entries are stored contiguously in insertion order (until one is erased), and the table holds only the 32-bit
+//! hash and index of each entry. A lookup compares the stored hashes first, so a key is only compared with entries
+//! whose hash matches, and the table itself fits in cache for far more entries than a node-based container. Keys are
+//! compared with the PathName rules (case-independent, '/' and '\' equivalent).
+//!
+//! @param	Entry   Type of an entry
+//! @param	KeyOf   Function object that returns the PathName key of an entry
+//!
+//! @note   Keys must not be modified through an iterator.
+
+template <typename Entry, typename KeyOf>
+class PathNameTable
+{
+public:
+
+    using value_type     = Entry;
+    using iterator       = typename std::vector<Entry>::iterator;
+    using const_iterator = typename std::vector<Entry>::const_iterator;
+
+    //! Returns the number of entries.
+    size_t size() const { return entries_.size(); }
+
+    //! Returns true if there are no entries.
+    bool empty() const { return entries_.empty(); }
+
+    //! Removes all entries.
+    void clear()
+    {
+        entries_.clear();
+        hashes_.clear();
+        slots_.assign(slots_.size(), Slot {});
+    }
+
+    //! Makes room for n entries without rehashing.
+    void reserve(size_t n)
+    {
+        entries_.reserve(n);
+        hashes_.reserve(n);
+        if (n > maxSize())
+            rehash(n);
+    }
+
+    //! Returns the entry with the key, or end() if there is none.
+    iterator find(PathNameView key)
+    {
+        size_t const i = indexOf(key, hashOf(key));
+        return (i != NONE) ? entries_.begin() + i : entries_.end();
+    }
+
+    //! Returns the entry with the key, or end() if there is none.
+    const_iterator find(PathNameView key) const
+    {
+        size_t const i = indexOf(key, hashOf(key));
+        return (i != NONE) ? entries_.begin() + i : entries_.end();
+    }
+
+    //! Returns true if there is an entry with the key.
+    bool contains(PathNameView key) const { return indexOf(key, hashOf(key)) != NONE; }
+
+    //! Removes the entry with the key, if there is one. The last entry takes its place.
+    //!
+    //! @return     true if an entry was removed
+    bool erase(PathNameView key)
+    {
+        uint32_t const hash = hashOf(key);
+        size_t         slot = findSlot(key, hash);
+        if (slot == NONE)
+            return false;
+
+        size_t const index = slots_[slot].index - 1;
+        removeSlot(slot);
+
+        // Move the last entry into the hole and point its slot at the new position
+        size_t const last = entries_.size() - 1;
+        if (index != last)
+        {
+            for (slot = hashes_[last] & mask(); slots_[slot].index != last + 1; slot = (slot + 1) & mask())
+            {
+            }
+            slots_[slot].index = static_cast<uint32_t>(index + 1);
+            entries_[index]    = std::move(entries_[last]);
+            hashes_[index]     = hashes_[last];
+        }
+        entries_.pop_back();
+        hashes_.pop_back();
+        return true;
+    }
+
+    iterator begin() { return entries_.begin(); }
+    iterator end() { return entries_.end(); }
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end() const { return entries_.end(); }
+
+protected:
+
+    //! Returns the entry with the key, adding one constructed from args if there is none.
+    //!
+    //! @return     The entry, and true if it was added
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(PathNameView key, Args &&... args)
+    {
+        uint32_t const hash = hashOf(key);
+        size_t const   i    = indexOf(key, hash);
+        if (i != NONE)
+            return { entries_.begin() + i, false };
+
+        if (entries_.size() + 1 > maxSize())
+            rehash(entries_.size() + 1);
+        entries_.emplace_back(std::forward<Args>(args)...);
+        hashes_.push_back(hash);
+        insertSlot(hash, entries_.size() - 1);
+        return { entries_.end() - 1, true };
+    }
+
+private:
+
+    // A slot in the table. An index of 0 marks an empty slot.
+    struct Slot
+    {
+        uint32_t hash  = 0;     // Hash of the entry
+        uint32_t index = 0;     // Index of the entry + 1
+    };
+
+    static size_t constexpr NONE = ~size_t(0);
+
+    static uint32_t hashOf(PathNameView key)
+    {
+        uint64_t const h = char_traits_path_char::hash(key.data(), key.size());
+        return static_cast<uint32_t>(h ^ (h >> 32));
+    }
+
+    size_t mask() const { return slots_.size() - 1; }
+
+    // The table is rehashed before it is 3/4 full
+    size_t maxSize() const { return slots_.size() / 4 * 3; }
+
+    // Returns the slot of the entry with the key, or NONE
+    size_t findSlot(PathNameView key, uint32_t hash) const
+    {
+        if (slots_.empty())
+            return NONE;
+        for (size_t slot = hash & mask(); slots_[slot].index != 0; slot = (slot + 1) & mask())
+        {
+            if (slots_[slot].hash == hash && PathNameView(KeyOf()(entries_[slots_[slot].index - 1])) == key)
+                return slot;
+        }
+        return NONE;
+    }
+
+    // Returns the index of the entry with the key, or NONE
+    size_t indexOf(PathNameView key, uint32_t hash) const
+    {
+        size_t const slot = findSlot(key, hash);
+        return (slot != NONE) ? slots_[slot].index - 1 : NONE;
+    }
+
+    void insertSlot(uint32_t hash, size_t index)
+    {
+        size_t slot = hash & mask();
+        while (slots_[slot].index != 0)
+        {
+            slot = (slot + 1) & mask();
+        }
+        slots_[slot] = Slot { hash, static_cast<uint32_t>(index + 1) };
+    }
+
+    // Empties a slot. The slots following it are shifted back so that no probe sequence is broken.
+    void removeSlot(size_t hole)
+    {
+        for (size_t slot = (hole + 1) & mask(); slots_[slot].index != 0; slot = (slot + 1) & mask())
+        {
+            size_t const home = slots_[slot].hash & mask();
+            if (((slot - home) & mask()) >= ((slot - hole) & mask()))
+            {
+                slots_[hole] = slots_[slot];
+                hole         = slot;
+            }
+        }
+        slots_[hole] = Slot {};
+    }
+
+    // Resizes the table to hold at least n entries. The stored hashes are reused, so no key is hashed again.
+    void rehash(size_t n)
+    {
+        size_t size = 16;
+        while (size / 4 * 3 < n)
+        {
+            size *= 2;
+        }
+        slots_.assign(size, Slot {});
+        for (size_t i = 0; i < hashes_.size(); ++i)
+        {
+            insertSlot(hashes_[i], i);
+        }
+    }
+
+    std::vector<Entry>    entries_;     // Entries
+    std::vector<uint32_t> hashes_;      // Hash of each entry
+    std::vector<Slot>     slots_;       // Hash table (the size is a power of 2)
+};
+
+//! @cond
+namespace PathNameMapDetail
+{
+struct SetKey
+{
+    PathName const & operator ()(PathName const & entry) const { return entry; }
+};
+
+template <typename T>
+struct MapKey
+{
+    PathName const & operator ()(std::pair<PathName, T> const & entry) const { return entry.first; }
+};
+} // namespace PathNameMapDetail
+//! @endcond
+
+//! A hash set of path names. See PathNameTable.
+
+class PathNameSet : public PathNameTable<PathName, PathNameMapDetail::SetKey>
+{
+public:
+
+    //! Adds a path name if it is not already in the set.
+    //!
+    //! @return     The entry, and true if it was added
+    std::pair<iterator, bool> insert(PathNameView path)
+    {
+        return emplace(path, path);
+    }
+};
+
+//! A hash map keyed by path names. See PathNameTable.
+//!
+//! @param	T       Type of the mapped values
+
+template <typename T>
+class PathNameMap : public PathNameTable<std::pair<PathName, T>, PathNameMapDetail::MapKey<T>>
+{
+    using Base = PathNameTable<std::pair<PathName, T>, PathNameMapDetail::MapKey<T>>;
+
+public:
+
+    using mapped_type = T;
+
+    //! Adds an entry if there is none with the key.
+    //!
+    //! @return     The entry with the key, and true if it was added
+    std::pair<typename Base::iterator, bool> insert(PathNameView key, T value)
+    {
+        return Base::emplace(key,
+                             std::piecewise_construct,
+                             std::forward_as_tuple(key),
+                             std::forward_as_tuple(std::move(value)));
+    }
+
+    //! Returns the value with the key, adding a default-constructed value if there is none.
+    T & operator [](PathNameView key)
+    {
+        // The key and value are only constructed if the entry is added
+        auto const entry = Base::emplace(key, std::piecewise_construct, std::forward_as_tuple(key), std::tuple<>());
+        return entry.first->second;
+    }
+};
+
+#endif // !defined(MISC_PATHNAMEMAP_H_INCLUDED)
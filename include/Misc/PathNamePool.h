@@ -0,0 +1,110 @@
+#if !defined(MISC_PATHNAMEPOOL_H_INCLUDED)
+#define MISC_PATHNAMEPOOL_H_INCLUDED
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//! A thread-safe pool of interned path names.
+//!
+//! Each path is canonicalized once when it is interned, and each distinct canonical path is stored once and identified
+//! by a 32-bit ID. Paths that are equal according to PathName, or that differ only in "." and ".." components or
+//! repeated separators, get the same ID, so comparing and hashing interned paths are integer operations. IDs are
+//! assigned consecutively from 0, so they can be used to index arrays.
+//!
+//! The canonical strings are stored in blocks that are never moved or freed while the pool exists, so the views
+//! returned by str() remain valid. For example:
+//! @code
+//!
+//!     PathNamePool pool;
+//!     PathNamePool::Id const a = pool.intern("Assets\\Textures\\..\\Models\\Tree.fbx");
+//!     PathNamePool::Id const b = pool.intern("assets/models/tree.FBX");
+//!     assert(a == b); @endcode
+
+class PathNamePool
+{
+public:
+
+    //! The ID of an interned path.
+    using Id = uint32_t;
+
+    //! An ID that is not assigned to any path.
+    static Id constexpr INVALID = ~Id(0);
+
+    //! Constructor.
+    PathNamePool();
+
+    //! Destructor.
+    ~PathNamePool();
+
+    //! Returns the ID of a path, interning it if it has not been interned already. Throws std::length_error if the
+    //! path is new and every ID other than INVALID has been assigned.
+    //!
+    //! @param  path    Path to intern
+    Id intern(std::string_view path);
+
+    //! Returns the ID of a path, or INVALID if it has not been interned.
+    //!
+    //! @param  path    Path to find
+    Id find(std::string_view path) const;
+
+    //! Returns the canonical form of an interned path. The string is followed by a 0.
+    //!
+    //! @param  id      ID of the path
+    std::string_view str(Id id) const;
+
+    //! Returns the number of paths in the pool.
+    size_t size() const;
+
+    //! Returns the canonical form of a path.
+    //!
+    //! The path is normalized by PathName::normalize(), and its characters are folded by char_traits_path_char::fold(),
+    //! so ASCII letters are uppercase, other letters are folded by Unicode simple case folding and every separator is
+    //! '/'. An empty path becomes ".".
+    //!
+    //! @param  path    Path to canonicalize
+    static std::string canonicalize(std::string_view path);
+
+private:
+
+    // Minimum size of a storage block
+    static size_t constexpr BLOCK_SIZE = 64 * 1024;
+
+    // A slot in the hash table. An entry of 0 marks an empty slot.
+    struct Slot
+    {
+        uint32_t hash  = 0;     // Hash of the path
+        uint32_t entry = 0;     // ID of the path + 1
+    };
+
+    // non-copyable
+    PathNamePool(PathNamePool const &) = delete;
+    PathNamePool & operator =(PathNamePool const &) = delete;
+
+    // Copies the canonical form of a path into canonical, reusing its storage
+    static void canonicalize(std::string_view path, std::string & canonical);
+
+    // Returns the ID of a canonical path, or INVALID. The caller must hold the lock.
+    Id lookup(std::string_view canonical, uint32_t hash) const;
+
+    // Copies a canonical path into the storage and returns a view of the copy. The caller must hold the lock.
+    std::string_view store(std::string_view canonical);
+
+    // Doubles the size of the hash table. The caller must hold the lock exclusively.
+    void grow();
+
+    mutable std::shared_mutex            mutex_;
+    std::vector<std::unique_ptr<char[]>> blocks_;               // Storage for the canonical paths
+    char *                               next_      = nullptr;  // Next free character in the current block
+    size_t                               available_ = 0;        // Number of free characters in the current block
+    std::vector<std::string_view>        paths_;                // Canonical path of each ID
+    std::vector<uint32_t>                hashes_;               // Hash of each path
+    std::vector<Slot>                    slots_;                // Hash table (the size is a power of 2)
+};
+
+#endif // !defined(MISC_PATHNAMEPOOL_H_INCLUDED)
@@ -0,0 +1,256 @@
+#if !defined(MISC_PATHTRIE_H_INCLUDED)
+#define MISC_PATHTRIE_H_INCLUDED
+#pragma once
+
+#include "PathName.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+//! The structure of a PathTrie, which does not depend on the type of the values.
+//!
+//! The trie is keyed by path components rather than characters. Each node is labeled with one or more components, so
+//! a chain of directories with a single entry each is a single node. An absolute path has an extra first component,
+//! "/". Components are compared with the PathName rules (case-independent, '/' and '\' equivalent), and "." and ".."
+//! are ordinary components, so paths should be normalized (see PathName::normalize()) if they may contain them.
+//!
+//! The nodes are stored contiguously and refer to each other by index. The labels are ranges of a shared array of
+//! components, so splitting a node copies no characters. The child of a node with a given first component is found
+//! in an open-addressing hash table keyed by the index of the parent and the hash of the component, so a lookup takes
+//! time proportional to the number of components in the path, however many entries a directory has.
+
+class PathTrieBase
+{
+public:
+
+    //! Removes all paths.
+    void clear();
+
+protected:
+
+    // A node of the trie
+    struct Node
+    {
+        uint32_t first;     // Index of the first component of the label
+        uint32_t count;     // Number of components in the label
+        uint32_t child;     // First child, or NONE
+        uint32_t sibling;   // Next child of the same parent, or NONE
+        uint32_t value;     // Index of the value + 1, or 0 if the node has no value
+        uint32_t hash;      // Hash of the first component of the label
+    };
+
+    static uint32_t constexpr NONE = ~uint32_t(0);
+
+    // Constructor
+    PathTrieBase();
+
+    // Returns the node of a path, adding nodes if necessary
+    uint32_t add(PathNameView path);
+
+    // Returns the node of a path, or NONE
+    uint32_t find(PathNameView path) const;
+
+    // Returns the highest node whose path begins with the prefix, or NONE, and appends the path of the node to path
+    uint32_t findPrefix(PathNameView prefix, std::string & path) const;
+
+    // Returns the deepest node with a value whose path is a prefix of the path, or NONE, and the number of characters of
+    // the path that it matches
+    uint32_t findLongestPrefix(PathNameView path, size_t & matched) const;
+
+    // Appends the components of the label of a node to a path
+    void appendLabel(uint32_t node, std::string & path) const;
+
+    std::vector<Node> nodes_;   // Nodes. The root, whose label is empty, is first.
+
+private:
+
+    // A component of a label
+    struct Component
+    {
+        uint32_t offset;    // Offset of the characters in text_
+        uint32_t size;      // Number of characters
+    };
+
+    // An entry in the table of edges. A child of 0 marks an empty entry, since the root is not a child.
+    struct Edge
+    {
+        uint32_t parent;    // Index of the parent
+        uint32_t hash;      // Hash of the first component of the child
+        uint32_t child;     // Index of the child
+    };
+
+    class Key;
+
+    // Returns a component of a label
+    std::string_view component(uint32_t i) const
+    {
+        return std::string_view(text_.data() + components_[i].offset, components_[i].size);
+    }
+
+    // Returns the index of the home slot of an edge
+    size_t home(uint32_t parent, uint32_t hash) const;
+
+    // Returns the child of a node whose label begins with a component, or NONE
+    uint32_t findChild(uint32_t parent, std::string_view c, uint32_t hash) const;
+
+    // Adds a node as the first child of a parent
+    uint32_t addChild(uint32_t parent, uint32_t hash);
+
+    // Splits a node after the first count components of its label. The node keeps its parent and the new node below it
+    // takes its children and value.
+    void split(uint32_t node, uint32_t count);
+
+    void insertEdge(Edge const & edge);
+    void removeEdge(uint32_t parent, uint32_t hash, uint32_t child);
+
+    std::vector<Component> components_;     // Components of the labels
+    std::string            text_;           // Characters of the components
+    std::vector<Edge>      edges_;          // Table of edges (the size is a power of 2)
+    size_t                 nEdges_ = 0;     // Number of edges in the table
+};
+
+//! A map from paths to values, for queries about directories. See PathTrieBase for the structure.
+//!
+//! Besides exact lookups, the trie finds every path under a directory in time proportional to the size of the result,
+//! and the entry with the longest prefix of a path, which is how a path is resolved against a set of mount points. For
+//! example:
+//! @code
+//!
+//!     PathTrie<Volume *> mounts;
+//!     mounts.insert("/data", &data);
+//!     mounts.insert("/data/cache", &cache);
+//!     auto const mount = mounts.longestPrefix("/Data/Cache/Shaders/Water.bin");  // &cache, "Shaders/Water.bin"
+//!
+//!     manifest.forEachUnder("Assets/Textures", [] (std::string_view path, Asset const & asset) { ... }); @endcode
+//!
+//! @param	T       Type of the values
+
+template <typename T>
+class PathTrie : public PathTrieBase
+{
+public:
+
+    //! Returns the number of paths.
+    size_t size() const { return values_.size(); }
+
+    //! Returns true if there are no paths.
+    bool empty() const { return values_.empty(); }
+
+    //! Removes all paths.
+    void clear()
+    {
+        PathTrieBase::clear();
+        values_.clear();
+    }
+
+    //! Adds a path if it is not already in the trie.
+    //!
+    //! @return     The value of the path, and true if it was added
+    std::pair<T &, bool> insert(PathNameView path, T value)
+    {
+        uint32_t const node = add(path);
+        if (nodes_[node].value != 0)
+            return { values_[nodes_[node].value - 1], false };
+        values_.push_back(std::move(value));
+        nodes_[node].value = static_cast<uint32_t>(values_.size());
+        return { values_.back(), true };
+    }
+
+    //! Returns the value of a path, adding a default-constructed value if there is none.
+    T & operator [](PathNameView path)
+    {
+        uint32_t const node = add(path);
+        if (nodes_[node].value == 0)
+        {
+            values_.emplace_back();
+            nodes_[node].value = static_cast<uint32_t>(values_.size());
+        }
+        return values_[nodes_[node].value - 1];
+    }
+
+    //! Returns the value of a path, or null if the path is not in the trie.
+    T * find(PathNameView path)
+    {
+        uint32_t const node = PathTrieBase::find(path);
+        return (node != NONE && nodes_[node].value != 0) ? &values_[nodes_[node].value - 1] : nullptr;
+    }
+
+    //! Returns the value of a path, or null if the path is not in the trie.
+    T const * find(PathNameView path) const
+    {
+        uint32_t const node = PathTrieBase::find(path);
+        return (node != NONE && nodes_[node].value != 0) ? &values_[nodes_[node].value - 1] : nullptr;
+    }
+
+    //! Returns true if the path is in the trie.
+    bool contains(PathNameView path) const { return find(path) != nullptr; }
+
+    //! Returns the value of the longest path in the trie that is a prefix of a path, and the rest of the path.
+    //!
+    //! Only whole components match. The rest of the path does not begin with a separator. If no path in the trie is a
+    //! prefix, the value is null and the rest is the whole path.
+    //!
+    //! @param  path    Path to resolve
+    std::pair<T const *, PathNameView> longestPrefix(PathNameView path) const
+    {
+        size_t         matched = 0;
+        uint32_t const node    = findLongestPrefix(path, matched);
+        if (node == NONE)
+            return { nullptr, path };
+        while (matched < path.size() && char_traits_path_char::is_slash(path[matched]))
+        {
+            ++matched;
+        }
+        return { &values_[nodes_[node].value - 1], path.substr(matched) };
+    }
+
+    //! Calls a function for each path in the trie that is, or is under, a prefix.
+    //!
+    //! The paths are visited in no particular order. The function is called with the path, whose components are
+    //! separated by '/' and spelled as when they were first inserted, and the value. The path is only valid during the
+    //! call.
+    //!
+    //! @param  prefix  Directory to search. Only whole components match. An empty prefix matches every path.
+    //! @param  f       Function called as <tt>f(std::string_view path, T const & value)</tt>
+    template <typename F>
+    void forEachUnder(PathNameView prefix, F && f) const
+    {
+        std::string    path;
+        uint32_t const top = findPrefix(prefix, path);
+        if (top == NONE)
+            return;
+
+        // Each entry of the stack is a node and the length of the path of its parent
+        std::vector<std::pair<uint32_t, size_t>> stack;
+        for (uint32_t child = nodes_[top].child; child != NONE; child = nodes_[child].sibling)
+        {
+            stack.emplace_back(child, path.size());
+        }
+        if (nodes_[top].value != 0)
+            f(std::string_view(path), values_[nodes_[top].value - 1]);
+
+        while (!stack.empty())
+        {
+            uint32_t const node = stack.back().first;
+            path.resize(stack.back().second);
+            stack.pop_back();
+            appendLabel(node, path);
+            for (uint32_t child = nodes_[node].child; child != NONE; child = nodes_[child].sibling)
+            {
+                stack.emplace_back(child, path.size());
+            }
+            if (nodes_[node].value != 0)
+                f(std::string_view(path), values_[nodes_[node].value - 1]);
+        }
+    }
+
+private:
+
+    std::vector<T> values_;     // Values, in insertion order
+};
+
+#endif // !defined(MISC_PATHTRIE_H_INCLUDED)
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
 
 //! Computes x!.
 int64_t factorial(int64_t x);
@@ -16,4 +17,16 @@ int64_t combinations(int64_t n, int64_t k);
 //! Computes "n multichoose k".
 int64_t multisets(int64_t n, int64_t k);
 
+//! Computes x!, or returns nothing if the result does not fit in an int64_t.
+std::optional<int64_t> checkedFactorial(int64_t x);
+
+//! Computes nPr, or returns nothing if the result does not fit in an int64_t.
+std::optional<int64_t> checkedPermutations(int64_t n, int64_t r);
+
+//! Computes nCk, or returns nothing if the result does not fit in an int64_t.
+std::optional<int64_t> checkedCombinations(int64_t n, int64_t k);
+
+//! Computes "n multichoose k", or returns nothing if the result does not fit in an int64_t.
+std::optional<int64_t> checkedMultisets(int64_t n, int64_t k);
+
 #endif // !defined(MISC_PROBABILITY_H_INCLUDED)
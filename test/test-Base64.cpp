@@ -10,6 +10,12 @@
 
 #include "gtest/gtest.h"
 
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
 using namespace Base64;
 
 const std::string rest0_original  = "abc";
@@ -57,3 +63,372 @@ TEST(Base64Test, Decode)
 
     EXPECT_EQ(rest2_decoded, rest2_original);
 }
+
+
+namespace
+{
+std::string makeData(size_t n)
+{
+    std::string data(n, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        data[i] = static_cast<char>((i * 167 + 13) & 0xff);
+    }
+    return data;
+}
+} // anonymous namespace
+
+TEST(Base64Test, EncoderChunked)
+{
+    // Chunked output must match the one-shot output for every chunk size and every remainder
+    for (size_t size = 0; size < 40; ++size)
+    {
+        std::string const data      = makeData(size);
+        std::string const reference = encode(reinterpret_cast<unsigned char const *>(data.data()), data.size());
+        for (size_t chunk = 1; chunk <= 7; ++chunk)
+        {
+            Encoder     encoder;
+            std::string encoded;
+            for (size_t i = 0; i < data.size(); i += chunk)
+            {
+                size_t n = std::min(chunk, data.size() - i);
+                encoder.update(reinterpret_cast<unsigned char const *>(data.data() + i), n, encoded);
+            }
+            encoder.finish(encoded);
+            EXPECT_EQ(encoded, reference) << "size = " << size << ", chunk = " << chunk;
+        }
+    }
+}
+
+TEST(Base64Test, DecoderChunked)
+{
+    for (size_t size = 0; size < 40; ++size)
+    {
+        std::string const data    = makeData(size);
+        std::string const encoded = encode(reinterpret_cast<unsigned char const *>(data.data()), data.size());
+        EXPECT_EQ(decode(encoded), data);
+        for (size_t chunk = 1; chunk <= 9; ++chunk)
+        {
+            Decoder     decoder;
+            std::string decoded;
+            for (size_t i = 0; i < encoded.size(); i += chunk)
+            {
+                size_t n = std::min(chunk, encoded.size() - i);
+                decoder.update(encoded.data() + i, n, decoded);
+            }
+            decoder.finish(decoded);
+            EXPECT_EQ(decoded, data) << "size = " << size << ", chunk = " << chunk;
+        }
+    }
+}
+
+TEST(Base64Test, DecoderStopsAtInvalidCharacter)
+{
+    // Everything after the first non-base64 character is ignored, regardless of how the input is split
+    std::string const encoded = "YWJjZGVm!YWJj";
+    EXPECT_EQ(decode(encoded), "abcdef");
+
+    Decoder     decoder;
+    std::string decoded;
+    decoder.update(encoded.data(), 7, decoded);
+    decoder.update(encoded.data() + 7, encoded.size() - 7, decoded);
+    EXPECT_TRUE(decoder.done());
+    decoder.finish(decoded);
+    EXPECT_EQ(decoded, "abcdef");
+    EXPECT_FALSE(decoder.done());
+}
+
+TEST(Base64Test, Parallel)
+{
+    // Large enough to be split, and not a multiple of the group size or of the number of threads
+    std::string const data      = makeData(3 * PARALLEL_THRESHOLD + 5);
+    std::string const reference = encode(reinterpret_cast<unsigned char const *>(data.data()), data.size());
+    for (unsigned nThreads : { 1u, 2u, 3u, 4u, 7u })
+    {
+        std::string const encoded = encodeParallel(reinterpret_cast<unsigned char const *>(data.data()), data.size(), nThreads);
+        EXPECT_EQ(encoded, reference) << "nThreads = " << nThreads;
+        EXPECT_EQ(decodeParallel(encoded, nThreads), data) << "nThreads = " << nThreads;
+    }
+
+    // The end of the input in the middle of a piece must give the same result as the serial decoder
+    std::string truncated = reference;
+    truncated[truncated.size() / 3 + 2] = '=';
+    EXPECT_EQ(decodeParallel(truncated, 4), decode(truncated));
+}
+
+TEST(Base64Test, DISABLED_ParallelScaling)
+{
+    // Reports throughput for each thread count. Run with --gtest_also_run_disabled_tests.
+    std::string const data    = makeData(256 * 1024 * 1024);
+    std::string const encoded = encode(reinterpret_cast<unsigned char const *>(data.data()), data.size());
+    unsigned const    maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned nThreads = 1; nThreads <= maxThreads; nThreads *= 2)
+    {
+        auto const start = std::chrono::steady_clock::now();
+        std::string e = encodeParallel(reinterpret_cast<unsigned char const *>(data.data()), data.size(), nThreads);
+        auto const middle = std::chrono::steady_clock::now();
+        std::string d = decodeParallel(encoded, nThreads);
+        auto const end = std::chrono::steady_clock::now();
+
+        double const encodeSeconds = std::chrono::duration<double>(middle - start).count();
+        double const decodeSeconds = std::chrono::duration<double>(end - middle).count();
+        std::cout << nThreads << " threads: encode " << data.size() / encodeSeconds / 1e9 << " GB/s, decode "
+                  << encoded.size() / decodeSeconds / 1e9 << " GB/s" << std::endl;
+        EXPECT_EQ(e.size(), encoded.size());
+        EXPECT_EQ(d.size(), data.size());
+    }
+}
+
+namespace
+{
+// The alphabet used by crypt(3), to test a custom alphabet
+struct Crypt
+{
+    static constexpr char CHARS[] = "./0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    static constexpr bool PADDED  = false;
+};
+} // anonymous namespace
+
+TEST(Base64Test, Alphabets)
+{
+    // 0xfb 0xff 0xbf encodes to the last two characters of the alphabet, and 0xfb 0xf0 requires padding
+    unsigned char const bytes[] = { 0xfb, 0xff, 0xbf, 0xfb, 0xf0 };
+
+    EXPECT_EQ(encode<Standard>(bytes, sizeof(bytes)), "+/+/+/A=");
+    EXPECT_EQ(encode<StandardNoPad>(bytes, sizeof(bytes)), "+/+/+/A");
+    EXPECT_EQ(encode<Url>(bytes, sizeof(bytes)), "-_-_-_A=");
+    EXPECT_EQ(encode<UrlNoPad>(bytes, sizeof(bytes)), "-_-_-_A");
+    EXPECT_EQ(encode<Crypt>(bytes, sizeof(bytes)), "yzyzyz.");
+
+    std::string const expected(reinterpret_cast<char const *>(bytes), sizeof(bytes));
+    EXPECT_EQ(decode<Standard>("+/+/+/A="), expected);
+    EXPECT_EQ(decode<StandardNoPad>("+/+/+/A"), expected);
+    EXPECT_EQ(decode<Url>("-_-_-_A="), expected);
+    EXPECT_EQ(decode<UrlNoPad>("-_-_-_A"), expected);
+    EXPECT_EQ(decode<Crypt>("yzyzyz."), expected);
+
+    // The characters of one alphabet are not valid in another
+    EXPECT_EQ(decode<Url>("+/+/"), "");
+
+    EXPECT_EQ(encodedSize<Standard>(5), 8u);
+    EXPECT_EQ(encodedSize<UrlNoPad>(5), 7u);
+}
+
+TEST(Base64Test, UnpaddedChunked)
+{
+    for (size_t size = 0; size < 20; ++size)
+    {
+        std::string const data      = makeData(size);
+        std::string const reference = encode<UrlNoPad>(reinterpret_cast<unsigned char const *>(data.data()), data.size());
+        EXPECT_EQ(reference.size(), encodedSize<UrlNoPad>(size));
+
+        BasicEncoder<UrlNoPad> encoder;
+        std::string            encoded;
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            encoder.update(reinterpret_cast<unsigned char const *>(data.data() + i), 1, encoded);
+        }
+        encoder.finish(encoded);
+        EXPECT_EQ(encoded, reference);
+        EXPECT_EQ(decode<UrlNoPad>(encoded), data);
+    }
+}
+
+TEST(Base64Test, LineBreaks)
+{
+    std::string const data     = makeData(100);
+    auto const        bytes    = reinterpret_cast<unsigned char const *>(data.data());
+    std::string const unbroken = encode(bytes, data.size());
+
+    // Lines are separated, but the last line is not terminated
+    std::string const pem = encode(bytes, data.size(), 64, "\n");
+    EXPECT_EQ(pem, unbroken.substr(0, 64) + "\n" + unbroken.substr(64, 64) + "\n" + unbroken.substr(128));
+    EXPECT_EQ(pem.size(), encodedSize(data.size(), 64, 1));
+
+    // A line length of 0 does not break the output, and other lengths are rounded down to whole groups
+    EXPECT_EQ(encode(bytes, data.size(), 0), unbroken);
+    EXPECT_EQ(encodedSize(data.size(), 0, 2), unbroken.size());
+    EXPECT_EQ(encode(bytes, data.size(), 3), unbroken);
+    EXPECT_EQ(encode(bytes, data.size(), 70, "\n"), encode(bytes, data.size(), 68, "\n"));
+    EXPECT_EQ(encode(bytes, data.size(), 70, "\n").size(), encodedSize(data.size(), 70, 1));
+
+    // An output that exactly fills the last line has no separator after it
+    std::string const exact = encode(bytes, 24, 16);
+    EXPECT_EQ(exact, unbroken.substr(0, 16) + "\r\n" + unbroken.substr(16, 16));
+
+    // Chunked encoding breaks lines at the same places
+    for (size_t chunk = 1; chunk <= 7; ++chunk)
+    {
+        Encoder     encoder(76);
+        std::string encoded;
+        for (size_t i = 0; i < data.size(); i += chunk)
+        {
+            encoder.update(bytes + i, std::min(chunk, data.size() - i), encoded);
+        }
+        encoder.finish(encoded);
+        EXPECT_EQ(encoded, encode(bytes, data.size(), 76)) << "chunk = " << chunk;
+    }
+
+    // Whitespace ends the input unless it is ignored
+    EXPECT_EQ(decode(pem), data.substr(0, 48));
+    EXPECT_EQ(decode(pem, true), data);
+    EXPECT_EQ(decode(" YW\r\nJj\tZA =\r\n=", true), "abcd");
+
+    for (size_t chunk = 1; chunk <= 9; ++chunk)
+    {
+        Decoder     decoder(true);
+        std::string decoded;
+        for (size_t i = 0; i < pem.size(); i += chunk)
+        {
+            decoder.update(pem.data() + i, std::min(chunk, pem.size() - i), decoded);
+        }
+        decoder.finish(decoded);
+        EXPECT_EQ(decoded, data) << "chunk = " << chunk;
+    }
+}
+
+TEST(Base64Test, Strict)
+{
+    struct Case
+    {
+        char const * input;
+        Error        error;
+        size_t       position;
+    };
+
+    Case const cases[] =
+    {
+        { "",           Error::NONE,          0 },
+        { "YWJj",       Error::NONE,          4 },
+        { "YWJjZA==",   Error::NONE,          8 },
+        { "YWJjZGU=",   Error::NONE,          8 },
+        { "YW!j",       Error::BAD_CHARACTER, 2 },
+        { "YWJjZA=!",   Error::BAD_PADDING,   7 },
+        { "YWJjZ===",   Error::BAD_PADDING,   5 },
+        { "YWJjZA",     Error::BAD_PADDING,   6 },
+        { "YWJjZA=",    Error::BAD_PADDING,   7 },
+        { "YWJjZA==YQ", Error::BAD_PADDING,   8 },
+        { "YW=jZA==",   Error::BAD_PADDING,   3 },
+        { "YWJjZB==",   Error::NON_CANONICAL, 5 },
+        { "YWJjZGV=",   Error::NON_CANONICAL, 6 },
+    };
+
+    for (auto const & c : cases)
+    {
+        std::string decoded;
+        Result      result = decodeStrict(c.input, decoded);
+        EXPECT_EQ(result.error, c.error) << c.input;
+        EXPECT_EQ(result.position, c.position) << c.input;
+        if (result)
+        {
+            EXPECT_EQ(decoded, decode(c.input)) << c.input;
+        }
+
+        result = validate(c.input);
+        EXPECT_EQ(result.error, c.error) << c.input;
+        EXPECT_EQ(result.position, c.position) << c.input;
+    }
+
+    // Unpadded alphabets do not allow padding, or a single character in the last quantum
+    EXPECT_EQ(validate<UrlNoPad>("YWJjZA").error, Error::NONE);
+    EXPECT_EQ(validate<UrlNoPad>("YWJjZA==").error, Error::BAD_PADDING);
+    EXPECT_EQ(validate<UrlNoPad>("YWJjZ").error, Error::BAD_PADDING);
+    EXPECT_EQ(validate<UrlNoPad>("YWJj+A").error, Error::BAD_CHARACTER);
+}
+
+TEST(Base64Test, ValidateLong)
+{
+    // Put a bad character at every position of an input long enough to use the block checks
+    std::string const data    = makeData(300);
+    std::string const encoded = encode(reinterpret_cast<unsigned char const *>(data.data()), data.size());
+    EXPECT_TRUE(validate(encoded));
+    EXPECT_TRUE(validate<Crypt>(encode<Crypt>(reinterpret_cast<unsigned char const *>(data.data()), 297)));
+    for (size_t i = 0; i < encoded.size() - 4; ++i)
+    {
+        for (char bad : { '*', '\x80', '-', '\n' })
+        {
+            std::string corrupt = encoded;
+            corrupt[i] = bad;
+            Result result = validate(corrupt);
+            EXPECT_EQ(result.error, Error::BAD_CHARACTER);
+            EXPECT_EQ(result.position, i);
+
+            std::string decoded;
+            result = decodeStrict(corrupt, decoded);
+            EXPECT_EQ(result.error, Error::BAD_CHARACTER);
+            EXPECT_EQ(result.position, i);
+            EXPECT_EQ(decoded, data.substr(0, i / 4 * 3));
+        }
+    }
+}
+
+TEST(Base64Test, Bytes)
+{
+    std::string const data    = makeData(100);
+    std::string const encoded = encode(reinterpret_cast<unsigned char const *>(data.data()), data.size());
+
+    std::vector<std::byte> const bytes = decodeBytes(encoded);
+    ASSERT_EQ(bytes.size(), data.size());
+    EXPECT_TRUE(std::equal(bytes.begin(), bytes.end(), data.begin(), [] (std::byte b, char c) {
+        return b == static_cast<std::byte>(c);
+    }));
+
+    std::vector<uint8_t> const u8 = decodeBytes<Standard, uint8_t>(encoded.data(), encoded.size());
+    EXPECT_EQ(std::string(u8.begin(), u8.end()), data);
+
+    // Bytes that are not valid UTF-8 or contain 0 survive
+    std::vector<unsigned char> const expected { 0x00, 0xff, 0x00 };
+    EXPECT_EQ((decodeBytes<Standard, unsigned char>("AP8A")), expected);
+
+    std::array<unsigned char, maxDecodedSize(8)> buffer;
+    EXPECT_EQ(decodeInto("YWJjZA==", 8, buffer), 4u);
+    EXPECT_EQ(std::string(buffer.begin(), buffer.begin() + 4), "abcd");
+}
+
+TEST(Base64Test, InPlace)
+{
+    std::string const data = makeData(100);
+    std::string const pem  = encode(reinterpret_cast<unsigned char const *>(data.data()), data.size(), 64);
+
+    std::string s = encode(reinterpret_cast<unsigned char const *>(data.data()), data.size());
+    decodeInPlace(s);
+    EXPECT_EQ(s, data);
+
+    s = pem;
+    decodeInPlace(s, true);
+    EXPECT_EQ(s, data);
+
+    s = pem;
+    size_t written;
+    s.erase(std::remove(s.begin(), s.end(), '\n'), s.end());
+    s.erase(std::remove(s.begin(), s.end(), '\r'), s.end());
+    EXPECT_TRUE(decodeStrict(s.data(), s.size(), reinterpret_cast<unsigned char *>(&s[0]), written));
+    EXPECT_EQ(s.substr(0, written), data);
+}
+
+TEST(Base64Test, Literals)
+{
+    constexpr auto encoded = encodeLiteral("abcde");
+    static_assert(encoded.size() == 8, "");
+    static_assert(encoded[6] == 'U' && encoded[7] == '=', "");
+    EXPECT_EQ(std::string(encoded.begin(), encoded.end()), rest2_reference);
+
+    constexpr auto unpadded = encodeLiteral<UrlNoPad>("abcde");
+    static_assert(unpadded.size() == 7, "");
+
+    static_assert(decodedSize("YWJj") == 3, "");
+    static_assert(decodedSize("YWJjZA==") == 4, "");
+    static_assert(decodedSize("YWJjZGU=") == 5, "");
+    static_assert(decodedSize("") == 0, "");
+
+    constexpr auto decoded = BASE64_DECODE_LITERAL("YWJjZGU=");
+    static_assert(decoded.size() == 5, "");
+    static_assert(decoded[0] == 'a' && decoded[4] == 'e', "");
+    EXPECT_EQ(std::string(decoded.begin(), decoded.end()), rest2_original);
+
+    constexpr auto url = decodeLiteral<3, UrlNoPad>("-_-_");
+    static_assert(url[0] == 0xfb && url[1] == 0xff && url[2] == 0xbf, "");
+
+    // The wrong size is an error
+    EXPECT_THROW(decodeLiteral<2>("YWJj"), std::logic_error);
+}
@@ -0,0 +1,109 @@
+#include "Misc/Base64Stream.h"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+
+using namespace Base64;
+
+namespace
+{
+std::string makeData(size_t n)
+{
+    std::string data(n, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        data[i] = static_cast<char>((i * 167 + 13) & 0xff);
+    }
+    return data;
+}
+} // anonymous namespace
+
+TEST(Base64StreamTest, Output)
+{
+    // Sizes around the internal buffer size, written in small pieces and in one large piece
+    for (size_t size : { 0, 1, 2, 3, 100, 3071, 3072, 3073, 10000 })
+    {
+        std::string const data      = makeData(size);
+        std::string const reference = encode(reinterpret_cast<unsigned char const *>(data.data()), data.size());
+
+        std::ostringstream target;
+        {
+            ostreambuf<> buffer(target.rdbuf());
+            std::ostream out(&buffer);
+            for (size_t i = 0; i < data.size(); i += 7)
+            {
+                out << data.substr(i, 7);
+            }
+        }
+        EXPECT_EQ(target.str(), reference) << "size = " << size;
+
+        target.str("");
+        ostreambuf<> buffer(target.rdbuf());
+        std::ostream out(&buffer);
+        out.write(data.data(), data.size());
+        out.flush();
+        EXPECT_TRUE(buffer.finish());
+        EXPECT_EQ(target.str(), reference) << "size = " << size;
+    }
+}
+
+TEST(Base64StreamTest, OutputLines)
+{
+    std::string const data = makeData(5000);
+
+    std::ostringstream target;
+    {
+        ostreambuf<Url> buffer(target.rdbuf(), 76);
+        std::ostream out(&buffer);
+        out.write(data.data(), 1000);
+        out.write(data.data() + 1000, 4000);
+    }
+    EXPECT_EQ(target.str(), encode<Url>(reinterpret_cast<unsigned char const *>(data.data()), data.size(), 76));
+}
+
+TEST(Base64StreamTest, Input)
+{
+    for (size_t size : { 0, 1, 2, 3, 100, 3071, 3072, 3073, 10000 })
+    {
+        std::string const data    = makeData(size);
+        std::string const encoded = encode(reinterpret_cast<unsigned char const *>(data.data()), data.size(), 64);
+
+        // Read a character at a time
+        {
+            std::istringstream source(encoded);
+            istreambuf<>       buffer(source.rdbuf(), true);
+            std::istream       in(&buffer);
+            std::string        decoded;
+            char               c;
+            while (in.get(c))
+            {
+                decoded += c;
+            }
+            EXPECT_EQ(decoded, data) << "size = " << size;
+        }
+
+        // Read in one large piece
+        {
+            std::istringstream source(encoded);
+            istreambuf<>       buffer(source.rdbuf(), true);
+            std::istream       in(&buffer);
+            std::string        decoded(size + 10, 0);
+            in.read(&decoded[0], decoded.size());
+            decoded.resize(static_cast<size_t>(in.gcount()));
+            EXPECT_EQ(decoded, data) << "size = " << size;
+        }
+    }
+}
+
+TEST(Base64StreamTest, InputStopsAtEnd)
+{
+    // Everything after the first character that is not base64 is ignored
+    std::istringstream source("YWJjZA==!rest");
+    istreambuf<>       buffer(source.rdbuf());
+    std::istream       in(&buffer);
+    std::string        decoded;
+    in >> decoded;
+    EXPECT_EQ(decoded, "abcd");
+}
@@ -2,7 +2,262 @@
 
 #include "gtest/gtest.h"
 
-TEST(CommandLineListTest, DISABLED_Placeholder)
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if defined(WIN32)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+std::vector<std::string> toStrings(CommandLineList const & list)
+{
+    return std::vector<std::string>(list.args().begin(), list.args().end());
+}
+
+// Creates a temporary directory containing empty files with the given names, and removes it when destroyed. The name
+// includes the process ID and the name of the test, so tests running in parallel processes do not share a directory.
+class TemporaryDirectory
+{
+public:
+    TemporaryDirectory(std::vector<std::string> const & files)
+        : path_(std::filesystem::temp_directory_path() /
+                ("CommandLineListTest-" + std::to_string(getpid()) + "-" +
+                 ::testing::UnitTest::GetInstance()->current_test_info()->name() + "-" + std::to_string(counter_++)))
+    {
+        std::filesystem::remove_all(path_);
+        for (auto const & file : files)
+        {
+            std::filesystem::path const p = path_ / file;
+            std::filesystem::create_directories(p.parent_path());
+            std::ofstream(p.string());
+        }
+    }
+    ~TemporaryDirectory()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(path_, error);
+    }
+
+    std::string path() const { return path_.generic_string(); }
+
+private:
+    static int counter_;
+    std::filesystem::path path_;
+};
+
+int TemporaryDirectory::counter_ = 0;
+} // anonymous namespace
+
+TEST(CommandLineListTest, CommandLine)
+{
+    CommandLineList list("  first second\t\"third arg\"  \"\" last");
+    EXPECT_EQ(list.argc(), 5u);
+    EXPECT_EQ(toStrings(list), (std::vector<std::string> { "first", "second", "third arg", "", "last" }));
+
+    // Each arg is terminated
+    for (auto const & arg : list.args())
+    {
+        EXPECT_EQ(arg.data()[arg.size()], 0);
+    }
+
+    EXPECT_EQ(CommandLineList("").argc(), 0u);
+    EXPECT_EQ(toStrings(CommandLineList("\"unterminated quote")), (std::vector<std::string> { "unterminated quote" }));
+}
+
+TEST(CommandLineListTest, Argv)
+{
+    char arg0[] = "command";
+    char arg1[] = "one";
+    char arg2[] = "two words";
+    char * argv[] = { arg0, arg1, arg2 };
+
+    CommandLineList list(3, argv);
+    EXPECT_EQ(toStrings(list), (std::vector<std::string> { "command", "one", "two words" }));
+    EXPECT_NE(list.args()[1].data(), arg1);
+}
+
+TEST(CommandLineListTest, CopyAndMove)
+{
+    CommandLineList original("a b c");
+    CommandLineList copy(original);
+    EXPECT_EQ(toStrings(copy), toStrings(original));
+    EXPECT_NE(copy.args()[0].data(), original.args()[0].data());
+
+    char const * const data = original.args()[0].data();
+    CommandLineList moved(std::move(original));
+    EXPECT_EQ(moved.args()[0].data(), data);
+    EXPECT_EQ(toStrings(moved), (std::vector<std::string> { "a", "b", "c" }));
+
+    copy = moved;
+    copy.include("d");
+    EXPECT_EQ(toStrings(copy), (std::vector<std::string> { "a", "b", "c", "d" }));
+    EXPECT_EQ(moved.argc(), 3u);
+}
+
+TEST(CommandLineListTest, Wildcards)
+{
+    TemporaryDirectory directory({ "a.txt", "b.txt", "c.dat" });
+    std::string const  path = directory.path();
+
+    CommandLineList list(("x " + path + "/*.txt " + path + "/*.none y").c_str());
+    EXPECT_EQ(toStrings(list), (std::vector<std::string> { "x", path + "/a.txt", path + "/b.txt", path + "/*.none", "y" }));
+}
+
+TEST(CommandLineListTest, BatchWildcards)
 {
-    GTEST_SKIP();
+    TemporaryDirectory first({ "a.txt", "b.txt", "c.dat", ".hidden.txt" });
+    TemporaryDirectory second({ "x.txt", "y.dat" });
+    std::string const  p1 = first.path();
+    std::string const  p2 = second.path();
+
+    std::vector<std::string> const patterns {
+        p1 + "/*.txt", "literal", p2 + "/*", p1 + "/?.dat", p2 + "/*.none", p1 + "/[ab].*", p1 + "/.*.txt"
+    };
+
+    // The results are the same as expanding each pattern by itself
+    CommandLineList batch("");
+    batch.include(std::vector<std::string_view>(patterns.begin(), patterns.end()));
+
+    CommandLineList single("");
+    for (auto const & pattern : patterns)
+    {
+        single.include(pattern.c_str());
+    }
+
+    EXPECT_EQ(toStrings(batch), toStrings(single));
+    EXPECT_EQ(toStrings(batch),
+              (std::vector<std::string> { p1 + "/a.txt", p1 + "/b.txt", "literal", p2 + "/x.txt", p2 + "/y.dat",
+                                          p1 + "/c.dat", p2 + "/*.none", p1 + "/a.txt", p1 + "/b.txt",
+                                          p1 + "/.hidden.txt" }));
+}
+
+TEST(CommandLineListTest, RecursiveWildcards)
+{
+    TemporaryDirectory directory({ "x.txt", "a/y.txt", "a/b/z.txt", "a/b/n.dat", "a/.hidden/h.txt", "c/b/w.txt" });
+    std::string const  p = directory.path();
+
+#if !defined(WIN32)
+    // A link back up the tree must not be followed forever
+    std::filesystem::create_directory_symlink("..", p + "/a/b/loop");
+
+    EXPECT_EQ(toStrings(CommandLineList((p + "/**/*.txt").c_str())),
+              (std::vector<std::string> { p + "/a/b/z.txt", p + "/a/y.txt", p + "/c/b/w.txt", p + "/x.txt" }));
+    EXPECT_EQ(toStrings(CommandLineList((p + "/**/b/*").c_str())),
+              (std::vector<std::string> { p + "/a/b/loop", p + "/a/b/n.dat", p + "/a/b/z.txt", p + "/c/b/w.txt" }));
+    EXPECT_EQ(toStrings(CommandLineList((p + "/c/**").c_str())),
+              (std::vector<std::string> { p + "/c/b", p + "/c/b/w.txt" }));
+    EXPECT_EQ(toStrings(CommandLineList((p + "/**/*.none").c_str())), (std::vector<std::string> { p + "/**/*.none" }));
+    EXPECT_EQ(toStrings(CommandLineList((p + "/c/** " + p + "/**/*.none " + p + "/**/y.txt").c_str())),
+              (std::vector<std::string> { p + "/c/b", p + "/c/b/w.txt", p + "/**/*.none", p + "/a/y.txt" }));
+
+    // A pattern ending with '/' only matches directories
+    EXPECT_EQ(toStrings(CommandLineList((p + "/**/").c_str())),
+              (std::vector<std::string> { p + "/a/", p + "/a/b/", p + "/a/b/loop/", p + "/c/", p + "/c/b/" }));
+#endif
+}
+
+TEST(CommandLineListTest, ResponseFiles)
+{
+    TemporaryDirectory directory({});
+    std::string const  p = directory.path();
+    std::filesystem::create_directories(p);
+    std::ofstream(p + "/outer.rsp") << "a \"b c\"\r\n@" << p << "/inner.rsp\nd";
+    std::ofstream(p + "/inner.rsp") << "  x @" << p << "/outer.rsp \"y\"\n";
+    std::ofstream(p + "/empty.rsp");
+
+    CommandLineList list(("first @" + p + "/outer.rsp @" + p + "/empty.rsp @" + p + "/missing.rsp last").c_str());
+    EXPECT_EQ(toStrings(list),
+              (std::vector<std::string> { "first", "a", "b c", "x", "@" + p + "/outer.rsp", "y", "d",
+                                          "@" + p + "/missing.rsp", "last" }));
+    for (auto const & arg : list.args())
+    {
+        EXPECT_EQ(arg.data()[arg.size()], 0);
+    }
+
+    // The views into the files remain valid after a move, and are copied by a copy
+    char const * const data = list.args()[1].data();
+    CommandLineList    moved(std::move(list));
+    EXPECT_EQ(moved.args()[1].data(), data);
+    CommandLineList copy(moved);
+    EXPECT_EQ(toStrings(copy), toStrings(moved));
+
+    // The files are not changed
+    std::ifstream      in(p + "/inner.rsp");
+    std::string const  inner((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(inner, "  x @" + p + "/outer.rsp \"y\"\n");
+}
+
+TEST(CommandLineListTest, LazyExpansion)
+{
+    TemporaryDirectory directory({ "x.txt", ".h.txt", "a/y.txt", "a/b/z.txt", "a/b/n.dat" });
+    std::string const  p = directory.path();
+
+    CommandLineList const list(("first " + p + "/*.txt " + p + "/**/*.dat " + p + "/*.none last").c_str(), false);
+    EXPECT_EQ(list.argc(), 5u);
+    EXPECT_EQ(list.args()[1], p + "/*.txt");
+
+    std::vector<std::string> expanded;
+    for (std::string_view arg : list.expansions())
+    {
+        expanded.emplace_back(arg);
+    }
+    EXPECT_EQ(expanded,
+              (std::vector<std::string> { "first", p + "/x.txt", p + "/a/b/n.dat", p + "/*.none", "last" }));
+
+    // The paths are not sorted, but they are the same as the eager expansion
+    for (char const * pattern : { "/**/*.txt", "/**/", "/*/", "/.*", "/a/.*/" })
+    {
+        CommandLineList const    eager(("first " + p + pattern).c_str());
+        CommandLineList const    unexpanded(("first " + p + pattern).c_str(), false);
+        std::vector<std::string> lazy;
+        for (std::string_view arg : unexpanded.expansions())
+        {
+            lazy.emplace_back(arg);
+        }
+        std::vector<std::string> expected = toStrings(eager);
+        std::sort(lazy.begin() + 1, lazy.end());
+        std::sort(expected.begin() + 1, expected.end());
+        EXPECT_EQ(lazy, expected) << pattern;
+    }
+
+    CommandLineList const empty("", false);
+    EXPECT_TRUE(empty.expansions().begin() == empty.expansions().end());
+}
+
+TEST(CommandLineListTest, RemoveDuplicates)
+{
+    CommandLineList list("b.txt a/b ./b.txt a//b c a/./b/ /a/b b.txt c");
+    list.removeDuplicates();
+    EXPECT_EQ(toStrings(list), (std::vector<std::string> { "b.txt", "a/b", "c", "/a/b" }));
+
+    list.removeDuplicates(true);
+    EXPECT_EQ(toStrings(list), (std::vector<std::string> { "/a/b", "a/b", "b.txt", "c" }));
+
+    // Overlapping wildcards
+    TemporaryDirectory directory({ "a.txt", "b.txt", "c.dat" });
+    std::string const  p = directory.path();
+    CommandLineList    overlapping(("" + p + "/*.txt " + p + "/a.* " + p + "/* " + p + "/./b.txt").c_str());
+    EXPECT_EQ(overlapping.argc(), 7u);
+    overlapping.removeDuplicates();
+    EXPECT_EQ(toStrings(overlapping), (std::vector<std::string> { p + "/a.txt", p + "/b.txt", p + "/c.dat" }));
+
+    // Enough args for a table much larger than the minimum
+    std::string many;
+    for (int i = 0; i < 10000; ++i)
+    {
+        many += "f" + std::to_string(i % 3000) + " ";
+    }
+    CommandLineList large(many.c_str());
+    large.removeDuplicates();
+    EXPECT_EQ(large.argc(), 3000u);
+    EXPECT_EQ(large.args()[2999], "f2999");
 }
@@ -0,0 +1,130 @@
+#include "Misc/GlobPattern.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+TEST(GlobPatternTest, Wildcards)
+{
+    EXPECT_TRUE(GlobPattern("*.cpp").matches("main.cpp"));
+    EXPECT_FALSE(GlobPattern("*.cpp").matches(".cpp"));
+    EXPECT_FALSE(GlobPattern("*.cpp").matches("main.h"));
+    EXPECT_FALSE(GlobPattern("*.cpp").matches("src/main.cpp"));
+    EXPECT_TRUE(GlobPattern("a*b*c").matches("abc"));
+    EXPECT_TRUE(GlobPattern("a*b*c").matches("aXbYbZc"));
+    EXPECT_FALSE(GlobPattern("a*b*c").matches("aXbYcZ"));
+    EXPECT_TRUE(GlobPattern("a**b").matches("aXXb"));
+    EXPECT_TRUE(GlobPattern("?x?").matches("axb"));
+    EXPECT_FALSE(GlobPattern("?x?").matches("axbc"));
+    EXPECT_FALSE(GlobPattern("a?b").matches("a/b"));
+    EXPECT_FALSE(GlobPattern("a*b").matches("a/b"));
+    EXPECT_TRUE(GlobPattern("*").matches(""));
+    EXPECT_TRUE(GlobPattern("").matches(""));
+}
+
+TEST(GlobPatternTest, Sets)
+{
+    GlobPattern const range("file[0-9].[ch]");
+    EXPECT_TRUE(range.matches("file1.c"));
+    EXPECT_TRUE(range.matches("file9.h"));
+    EXPECT_FALSE(range.matches("fileA.c"));
+    EXPECT_FALSE(range.matches("file1.o"));
+
+    EXPECT_TRUE(GlobPattern("[!a]").matches("b"));
+    EXPECT_FALSE(GlobPattern("[^a]").matches("a"));
+    EXPECT_FALSE(GlobPattern("a[!b]c").matches("a/c"));
+    EXPECT_TRUE(GlobPattern("[]]").matches("]"));
+    EXPECT_TRUE(GlobPattern("[a-]").matches("-"));
+
+    // An unterminated set is literal
+    EXPECT_TRUE(GlobPattern("a[b").matches("a[b"));
+    EXPECT_TRUE(GlobPattern("a[b").isLiteral());
+}
+
+TEST(GlobPatternTest, Escapes)
+{
+    EXPECT_TRUE(GlobPattern("a\\*b").matches("a*b"));
+    EXPECT_FALSE(GlobPattern("a\\*b").matches("axb"));
+    EXPECT_TRUE(GlobPattern("\\[x]").matches("[x]"));
+    EXPECT_TRUE(GlobPattern("\\[x]").isLiteral());
+}
+
+TEST(GlobPatternTest, HiddenNames)
+{
+    EXPECT_FALSE(GlobPattern("*").matches(".profile"));
+    EXPECT_FALSE(GlobPattern("?profile").matches(".profile"));
+    EXPECT_FALSE(GlobPattern("[.]profile").matches(".profile"));
+    EXPECT_TRUE(GlobPattern(".*").matches(".profile"));
+    EXPECT_FALSE(GlobPattern("src/*").matches("src/.git"));
+    EXPECT_TRUE(GlobPattern("src/*.git").matches("src/a.git"));
+    EXPECT_FALSE(GlobPattern("**/*.cpp").matches(".git/main.cpp"));
+    EXPECT_TRUE(GlobPattern("**/.git/*.cpp").matches("a/.git/main.cpp"));
+}
+
+TEST(GlobPatternTest, Recursive)
+{
+    GlobPattern const sources("src/**/*.cpp");
+    EXPECT_TRUE(sources.matches("src/main.cpp"));
+    EXPECT_TRUE(sources.matches("src/a/main.cpp"));
+    EXPECT_TRUE(sources.matches("src/a/b/c/main.cpp"));
+    EXPECT_FALSE(sources.matches("src/a/b/c/main.h"));
+    EXPECT_FALSE(sources.matches("lib/src/main.cpp"));
+    EXPECT_EQ(sources.prefix(), "src/");
+
+    GlobPattern const twice("**/test/**/*.h");
+    EXPECT_TRUE(twice.matches("test/a.h"));
+    EXPECT_TRUE(twice.matches("x/y/test/a.h"));
+    EXPECT_TRUE(twice.matches("x/test/y/test/z/a.h"));
+    EXPECT_FALSE(twice.matches("x/tests/a.h"));
+
+    // A trailing "**" matches everything below its directory, but not the directory itself
+    GlobPattern const all("include/**");
+    EXPECT_TRUE(all.matches("include/a"));
+    EXPECT_TRUE(all.matches("include/a/b.h"));
+    EXPECT_FALSE(all.matches("include"));
+
+    EXPECT_TRUE(GlobPattern("**").matches("a/b/c"));
+    EXPECT_TRUE(GlobPattern("a/**/b").matches("a/b"));
+    EXPECT_FALSE(GlobPattern("a/**/b").matches("ab"));
+}
+
+TEST(GlobPatternTest, Literal)
+{
+    GlobPattern const pattern("include/Misc/Etc.h");
+    EXPECT_TRUE(pattern.isLiteral());
+    EXPECT_EQ(pattern.prefix(), "include/Misc/Etc.h");
+    EXPECT_TRUE(pattern.matches("include/Misc/Etc.h"));
+    EXPECT_FALSE(pattern.matches("include/Misc/Etc.hpp"));
+
+    EXPECT_TRUE(GlobPattern::hasWildcards("a/*.h"));
+    EXPECT_TRUE(GlobPattern::hasWildcards("[ab]"));
+    EXPECT_FALSE(GlobPattern::hasWildcards("a/b.h"));
+}
+
+TEST(GlobPatternTest, DISABLED_Throughput)
+{
+    // Reports the number of paths matched per second. Run with --gtest_also_run_disabled_tests.
+    std::vector<std::string> paths;
+    for (int i = 0; i < 1000000; ++i)
+    {
+        paths.push_back("project/module" + std::to_string(i % 100) + "/src/detail/file" + std::to_string(i) +
+                        ((i % 3 == 0) ? ".cpp" : ".h"));
+    }
+
+    for (char const * p : { "project/**/*.cpp", "project/module1?/src/*/file*7.h", "**/detail/*[05].cpp" })
+    {
+        GlobPattern const pattern(p);
+        auto const        start = std::chrono::steady_clock::now();
+        size_t            count = 0;
+        for (auto const & path : paths)
+        {
+            count += pattern.matches(path);
+        }
+        double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << p << ": " << count << " matches, " << paths.size() / seconds / 1e6 << " M paths/s" << std::endl;
+        EXPECT_GT(count, 0u);
+    }
+}
@@ -2,7 +2,451 @@
 
 #include "gtest/gtest.h"
 
-TEST(PathNameTest, DISABLED_Placeholder)
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <locale>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+// The traits as they were before the fold table, for comparison
+struct legacy_char_traits_path_char : public std::char_traits<char>
+{
+    static bool eq(char _Left, char _Right)
+    {
+        return _Left == _Right ||
+               (is_slash(_Left) && is_slash(_Right)) ||
+               std::toupper(_Left, std::locale()) == std::toupper(_Right, std::locale());
+    }
+
+    static bool lt(char _Left, char _Right)
+    {
+        return (!is_slash(_Left) || !is_slash(_Right)) &&
+               std::toupper(_Left, std::locale()) < std::toupper(_Right, std::locale());
+    }
+
+    static int compare(const char * _First1, const char * _First2, size_t _Count)
+    {
+        while (_Count > 0 && eq(*_First1, *_First2))
+        {
+            --_Count;
+            ++_First1;
+            ++_First2;
+        }
+
+        if (_Count <= 0)
+            return 0;
+        else if (lt(*_First1, *_First2))
+            return -1;
+        else
+            return +1;
+    }
+
+    static const char * find(const char * _First, size_t _Count, char _Ch)
+    {
+        while (_Count > 0 && !eq(*_First, _Ch))
+        {
+            --_Count;
+            ++_First;
+        }
+
+        if (_Count <= 0)
+            return 0;
+        else
+            return _First;
+    }
+
+    static bool is_slash(char c)
+    {
+        return c == '\\' || c == '/';
+    }
+};
+
+using LegacyPathString = std::basic_string<char, legacy_char_traits_path_char>;
+using PathString       = std::basic_string<char, char_traits_path_char>;
+
+PathName path(char const * s)
+{
+    PathName p;
+    p.assign(s);
+    return p;
+}
+} // anonymous namespace
+
+TEST(PathNameTest, Fold)
+{
+    for (int c = 0; c < 256; ++c)
+    {
+        unsigned char const expected = (c == '\\') ? '/' : (c < 128) ? static_cast<unsigned char>(toupper(c)) : c;
+        EXPECT_EQ(char_traits_path_char::fold(static_cast<char>(c)), expected) << c;
+    }
+    static_assert(char_traits_path_char::eq('a', 'A'), "fold is constexpr");
+    static_assert(char_traits_path_char::eq('\\', '/'), "fold is constexpr");
+    static_assert(char_traits_path_char::lt('a', 'B'), "fold is constexpr");
+}
+
+TEST(PathNameTest, Compare)
 {
-    GTEST_SKIP();
+    EXPECT_EQ(path("C:\\Program Files\\Misc\\README.md"), path("c:/program files/misc/readme.MD"));
+    EXPECT_NE(path("a/b"), path("a/c"));
+    EXPECT_LT(path("a/b"), path("A/C"));
+    EXPECT_LT(path("ab"), path("abc"));
+    EXPECT_LT(path("A/b"), path("a_b"));
+
+    // '\' and '/' are equivalent in ordering too
+    EXPECT_FALSE(path("a\\b") < path("a/b"));
+    EXPECT_FALSE(path("a/b") < path("a\\b"));
+
+    // Characters above 0x7f are ordered as unsigned values
+    EXPECT_LT(path("a"), path("\xe9"));
+}
+
+TEST(PathNameTest, CompareBlocks)
+{
+    // Place a single difference at every position of strings long enough to use every block size
+    std::string const base = "Some/Long/Path/With/Many/Components/And/A/File.Name.Extension/Even/Longer/Than/This";
+    std::string       lower(base);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [] (char c) { return static_cast<char>(tolower(c)); });
+    std::replace(lower.begin(), lower.end(), '/', '\\');
+
+    for (size_t i = 0; i < base.size(); ++i)
+    {
+        EXPECT_EQ(char_traits_path_char::compare(base.c_str(), lower.c_str(), base.size()), 0);
+
+        std::string changed(lower);
+        changed[i] = '~';
+        EXPECT_EQ(char_traits_path_char::compare(base.c_str(), changed.c_str(), base.size()), -1) << i;
+        EXPECT_EQ(char_traits_path_char::compare(changed.c_str(), base.c_str(), base.size()), +1) << i;
+        EXPECT_EQ(char_traits_path_char::compare(base.c_str(), changed.c_str(), i), 0) << i;
+    }
+}
+
+TEST(PathNameTest, Find)
+{
+    std::string const s = "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ\\tail";
+    for (size_t i = 0; i < 36; ++i)
+    {
+        EXPECT_EQ(char_traits_path_char::find(s.c_str(), s.size(), s[i]), s.c_str() + i) << i;
+        EXPECT_EQ(char_traits_path_char::find(s.c_str() + i + 1, std::min<size_t>(40, s.size() - i - 1), s[i]),
+                  (i < 26) ? s.c_str() + i + 36 : nullptr) << i;
+    }
+    EXPECT_EQ(char_traits_path_char::find(s.c_str(), s.size(), '/'), s.c_str() + 62);
+    EXPECT_EQ(char_traits_path_char::find(s.c_str(), s.size(), '!'), nullptr);
+    EXPECT_EQ(char_traits_path_char::find(s.c_str(), 0, 'a'), nullptr);
+
+    EXPECT_EQ(path("Dir\\Sub/File.TXT").find("sub\\file"), 4u);
+    EXPECT_EQ(path("Dir\\Sub/File.TXT").rfind('/'), 7u);
+}
+
+TEST(PathNameTest, Utf8)
+{
+    auto equal = [] (char const * a, char const * b) {
+        return PathName(a) == PathName(b) &&
+               char_traits_path_char::hash(a, strlen(a)) == char_traits_path_char::hash(b, strlen(b));
+    };
+    EXPECT_TRUE(equal("\xc3\x84rger/\xd0\xa4\xd0\xb0\xd0\xb9\xd0\xbb.txt",
+                      "\xc3\xa4RGER\\\xd1\x84\xd0\xb0\xd0\x99\xd0\x9b.TXT"));
+    EXPECT_TRUE(equal("\xce\x9f\xce\x94\xce\x9f\xce\xa3", "\xce\xbf\xce\xb4\xce\xbf\xcf\x82"));      // Final sigma
+    EXPECT_TRUE(equal("\xd0\xa0", "\xd1\x80"));                                  // Different lead bytes
+    EXPECT_TRUE(equal("\xf0\x90\x90\x80", "\xf0\x90\x90\xa8"));                  // Deseret, 4 bytes
+    EXPECT_TRUE(equal("\xe2\x85\xa0", "\xe2\x85\xb0"));                          // Roman numeral one
+    EXPECT_FALSE(equal("STRASSE", "stra\xc3\x9f" "e"));                            // Changes the length
+    EXPECT_FALSE(equal("\xe2\x84\xaa", "k"));                                     // Kelvin sign folds to ASCII
+    EXPECT_FALSE(equal("\xc3\x84", "\xc3\xa5"));
+    EXPECT_FALSE(equal("\xc3", "\xe3"));                                           // Incomplete sequences
+    EXPECT_TRUE(PathName("\xc3\x84") < PathName("\xc3\xa5"));
+
+    // A sequence cut by the end of a view is incomplete, and is compared and hashed byte by byte. Nothing past the end
+    // of the view is read, which the sanitizers check with a buffer that is not terminated.
+    EXPECT_TRUE(equal("\xd0\x80", "\xd1\x90"));
+    EXPECT_FALSE(PathNameView("\xd0\x80", 1) == PathNameView("\xd1", 1));
+    EXPECT_TRUE(PathNameView("\xd0\x80", 1) < PathNameView("\xd1\x90", 1));
+    EXPECT_TRUE(PathName("\xd0") < PathName("\xd0\x80"));
+    std::unique_ptr<char[]> const cut(new char[1] { '\xd0' });
+    PathNameView const            view(cut.get(), 1);
+    EXPECT_TRUE(view < PathNameView("\xd0\x80"));
+    EXPECT_TRUE(view < PathNameView("\xd1\x90"));
+    EXPECT_TRUE(PathNameView("\xd1\x90") > view);
+    EXPECT_EQ(view, PathNameView("\xd0"));
+    EXPECT_EQ(std::hash<PathNameView>()(view), std::hash<PathNameView>()(PathNameView("\xd0")));
+
+    char folded[] = "D\xc3\x89j\xc3\xa0\\Vu\xc3\xa9";
+    char_traits_path_char::fold(folded, strlen(folded), folded);
+    EXPECT_STREQ(folded, "D\xc3\xa9J\xc3\xa0/VU\xc3\xa9");
+
+    // Long strings are folded and hashed in chunks, wherever the characters fall relative to the ends of the chunks
+    for (size_t offset = 0; offset < 10; ++offset)
+    {
+        std::string upper(offset, 'X');
+        std::string lower(offset, 'x');
+        for (int k = 0; k < 100; ++k)
+        {
+            upper += "\xd0\xa0" "\xe2\x85\xa0" "\xf0\x90\x90\x80" "\xc3";
+            lower += "\xd1\x80" "\xe2\x85\xb0" "\xf0\x90\x90\xa8" "\xc3";
+        }
+        EXPECT_TRUE(equal(upper.c_str(), lower.c_str())) << offset;
+    }
+
+    // compare() and hash() agree with comparing the folded common prefixes as bytes and then the lengths, with
+    // non-ASCII characters at every position relative to the blocks, and with truncated and invalid sequences. Views
+    // that cut the strings at the same place are equal only if their hashes are. For valid UTF-8, PathName::sort()
+    // agrees with a stable sort.
+    char const * const characters[] = { "a", "B", "/", "\\", "\xc3\x89", "\xc3\xa9", "\xd0\xa0", "\xd1\x80",
+                                        "\xd0\x80", "\xd1\x90", "\xe2\x85\xa0", "\xe2\x85\xb0",
+                                        "\xf0\x90\x90\x80", "\xf0\x90\x90\xa8", "z",
+                                        "\xc3", "\xd0", "\xd1", "\xe2\x85", "\xf0\x90\x90",    // Truncated
+                                        "\x80", "\x90", "\xc0\x80", "\xf5\x80\x80\x80" };     // Invalid
+    size_t const       nCharacters  = sizeof(characters) / sizeof(characters[0]);
+    size_t const       nValid       = 15;
+    auto foldPrefix = [] (std::string const & s, size_t n) {
+        std::string f = s.substr(0, n);
+        char_traits_path_char::fold(f.data(), f.size(), &f[0]);
+        return f;
+    };
+    unsigned           seed         = 1;
+    auto random = [&seed] (unsigned n) {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 16) % n;
+    };
+    std::vector<PathName> paths;
+    for (int trial = 0; trial < 20000; ++trial)
+    {
+        std::string       a(random(40), 'x');
+        std::string       b = a;
+        unsigned const    n = random(6);
+        bool              valid = true;
+        for (unsigned k = 0; k < n; ++k)
+        {
+            size_t const x = random(nCharacters);
+            size_t const y = random(nCharacters);
+            a     += characters[x];
+            b     += characters[y];
+            valid  = valid && x < nValid && y < nValid;
+        }
+
+        size_t const      common   = std::min(a.size(), b.size());
+        std::string const fa       = foldPrefix(a, common);
+        std::string const fb       = foldPrefix(b, common);
+        int const         expected = (fa != fb) ? ((fa < fb) ? -1 : +1) : (a.size() > b.size()) - (a.size() < b.size());
+        int const         actual   = PathName(a.data(), a.size()).compare(PathName(b.data(), b.size()));
+        ASSERT_EQ((actual > 0) - (actual < 0), expected) << a << " " << b;
+        if (expected == 0)
+        {
+            ASSERT_EQ(char_traits_path_char::hash(a.data(), a.size()), char_traits_path_char::hash(b.data(), b.size()));
+        }
+
+        size_t const cut = random(static_cast<unsigned>(common) + 1);
+        if (PathNameView(a.data(), cut) == PathNameView(b.data(), cut))
+        {
+            ASSERT_EQ(foldPrefix(a, cut), foldPrefix(b, cut));
+            ASSERT_EQ(char_traits_path_char::hash(a.data(), cut), char_traits_path_char::hash(b.data(), cut));
+        }
+        if (valid && paths.size() < 4000)
+        {
+            paths.emplace_back(a.data(), a.size());
+            paths.emplace_back(b.data(), b.size());
+        }
+    }
+
+    std::vector<PathName> expected = paths;
+    std::stable_sort(expected.begin(), expected.end());
+    PathName::sort(paths);
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        ASSERT_EQ(std::string(paths[i].data(), paths[i].size()), std::string(expected[i].data(), expected[i].size()));
+    }
+}
+
+TEST(PathNameTest, Components)
+{
+    auto components = [] (char const * p) {
+        std::vector<std::string> result;
+        for (std::string_view c : PathComponents(p))
+        {
+            result.emplace_back(c);
+        }
+        return result;
+    };
+    EXPECT_EQ(components("/a//b\\\\c/"), (std::vector<std::string> { "a", "b", "c" }));
+    EXPECT_EQ(components("./x/../y.txt"), (std::vector<std::string> { ".", "x", "..", "y.txt" }));
+    EXPECT_EQ(components("file"), (std::vector<std::string> { "file" }));
+    EXPECT_TRUE(components("").empty());
+    EXPECT_TRUE(components("//\\").empty());
+
+    // The components are views of the path
+    PathName const              p("Dir\\Sub/File");
+    PathComponents const        range(p);
+    PathComponents::iterator    i = range.begin();
+    EXPECT_EQ(i->data(), p.data());
+    EXPECT_EQ(*++i, "Sub");
+    EXPECT_EQ(i->data(), p.data() + 4);
+    EXPECT_EQ(*i++, "Sub");
+    EXPECT_EQ(*i, "File");
+    EXPECT_EQ(++i, range.end());
+}
+
+TEST(PathNameTest, Normalize)
+{
+    auto normalize = [] (char const * p) {
+        PathName path(p);
+        return std::string(path.normalize().c_str());
+    };
+    EXPECT_EQ(normalize("a//b/./c/"), "a/b/c");
+    EXPECT_EQ(normalize("Dir\\Sub\\File.TXT"), "Dir/Sub/File.TXT");
+    EXPECT_EQ(normalize("a/b/../../c"), "c");
+    EXPECT_EQ(normalize("a/../../c"), "../c");
+    EXPECT_EQ(normalize("../../a/.."), "../..");
+    EXPECT_EQ(normalize("a/b/../.."), ".");
+    EXPECT_EQ(normalize("/../a"), "/a");
+    EXPECT_EQ(normalize("\\a\\..\\.."), "/");
+    EXPECT_EQ(normalize("//"), "/");
+    EXPECT_EQ(normalize("./"), ".");
+    EXPECT_EQ(normalize(""), "");
+    EXPECT_EQ(normalize("..a/b../.../."), "..a/b../...");
+    EXPECT_EQ(normalize("c:\\x\\..\\y"), "c:/y");
+    EXPECT_EQ(normalize("C:\\a\\..\\.."), "C:/");
+    EXPECT_EQ(normalize("C:a\\..\\..\\b"), "C:../b");
+    EXPECT_EQ(normalize("C:.."), "C:..");
+    EXPECT_EQ(normalize("C:."), "C:");
+    EXPECT_EQ(normalize("\\\\server\\share\\x"), "//server/share/x");
+    EXPECT_EQ(normalize("//server//share/../.."), "//server/share");
+    EXPECT_EQ(normalize("//server/"), "//server");
+    EXPECT_EQ(normalize("///a"), "/a");
+
+    char   buffer[] = "x/./y/../z";
+    size_t size     = PathName::normalize(buffer, sizeof(buffer) - 1);
+    EXPECT_EQ(std::string(buffer, size), "x/z");
+}
+
+TEST(PathNameTest, FixedPathName)
+{
+    FixedPathName<> path("Assets\\Textures");
+    EXPECT_EQ(path.size(), 15u);
+    EXPECT_EQ(path, "assets/textures");
+    EXPECT_EQ(path, PathName("ASSETS/TEXTURES"));
+    EXPECT_EQ(PathName("ASSETS/TEXTURES"), path);
+    EXPECT_TRUE(path < "Assets/Z");
+    EXPECT_TRUE("Assets/Z" > path);
+    EXPECT_EQ(std::hash<FixedPathName<>>()(path), std::hash<PathName>()(PathName("assets/textures")));
+
+    path += '/';
+    path.append("./Old/../Stone.dds").normalize();
+    EXPECT_STREQ(path.c_str(), "Assets/Textures/Stone.dds");
+    EXPECT_EQ(path.str(), PathName("assets/textures/stone.dds"));
+    EXPECT_EQ(path.view().find("stone"), 16u);
+
+    FixedPathName<> copy(path);
+    path.pop_back();
+    EXPECT_EQ(copy, "Assets/Textures/Stone.dds");
+    copy = path;
+    EXPECT_EQ(copy, "Assets/Textures/Stone.dd");
+    copy.clear();
+    EXPECT_TRUE(copy.empty());
+    EXPECT_STREQ(copy.c_str(), "");
+
+    FixedPathName<8> small("12345678");
+    EXPECT_THROW(small.push_back('9'), std::length_error);
+    EXPECT_THROW(small.append("x"), std::length_error);
+    EXPECT_THROW(FixedPathName<8>("123456789"), std::length_error);
+    EXPECT_EQ(small, "12345678");
+    small.resize(4);
+    EXPECT_EQ(small, "1234");
+}
+
+TEST(PathNameTest, Sort)
+{
+    // Paths with long common prefixes, differences in case and separators, lengths around multiples of 8, embedded
+    // zeros and characters above 0x7f
+    std::vector<PathName> paths;
+    char const * const    parts[] = { "a", "B", "\\", "/", "\xc3\x89", "\xc3\xa9", "", "\xe9" };    // 6 is a zero
+    unsigned              seed    = 12345;
+    for (int i = 0; i < 5000; ++i)
+    {
+        std::string path = (i % 3 == 0) ? "Assets/Textures/Environment/" : "";
+        seed = seed * 1103515245u + 12345u;
+        for (unsigned n = (seed >> 16) % 20; n > 0; --n)
+        {
+            seed  = seed * 1103515245u + 12345u;
+            unsigned const k = (seed >> 16) % 8;
+            path += (k == 6) ? std::string(1, '\0') : std::string(parts[k]);
+        }
+        paths.emplace_back(path.data(), path.size());
+    }
+
+    // Equal paths keep their original order, so the results match a stable sort even where the spelling differs
+    std::vector<PathName> expected = paths;
+    std::stable_sort(expected.begin(), expected.end());
+    std::vector<PathNameView> views(paths.begin(), paths.end());
+    PathName::sort(views);
+    for (size_t i = 0; i < views.size(); ++i)
+    {
+        EXPECT_EQ(std::string(views[i].data(), views[i].size()), std::string(expected[i].data(), expected[i].size()))
+            << i;
+    }
+    PathName::sort(paths);
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        EXPECT_EQ(std::string(paths[i].data(), paths[i].size()), std::string(expected[i].data(), expected[i].size()))
+            << i;
+    }
+
+    std::vector<PathName> empty;
+    PathName::sort(empty);
+    EXPECT_TRUE(empty.empty());
+}
+
+TEST(PathNameTest, DISABLED_Benchmark)
+{
+    // Compares the traits with the legacy ones. Run with --gtest_also_run_disabled_tests.
+    std::vector<std::string> paths;
+    for (int i = 0; i < 100000; ++i)
+    {
+        paths.push_back("Assets/Textures/Environment/Level" + std::to_string(i % 50) + "/Material_" +
+                        std::to_string(i) + ".dds");
+    }
+
+    auto run = [&paths] (auto tag, char const * name) {
+        using String = decltype(tag);
+        std::vector<String> strings;
+        for (auto const & p : paths)
+        {
+            strings.emplace_back(p.c_str(), p.size());
+        }
+
+        auto const start = std::chrono::steady_clock::now();
+        std::sort(strings.begin(), strings.end());
+        auto const middle = std::chrono::steady_clock::now();
+        size_t     found  = 0;
+        for (auto const & s : strings)
+        {
+            found += s.find('.') != String::npos;
+            found += s.compare(strings.front()) == 0;
+        }
+        auto const end = std::chrono::steady_clock::now();
+
+        std::cout << name << ": sort " << std::chrono::duration<double, std::milli>(middle - start).count()
+                  << " ms, find and compare " << std::chrono::duration<double, std::milli>(end - middle).count()
+                  << " ms" << std::endl;
+        EXPECT_EQ(found, strings.size() + 1);
+    };
+
+    std::vector<PathName> names;
+    for (auto const & p : paths)
+    {
+        names.emplace_back(p.c_str(), p.size());
+    }
+    auto const start = std::chrono::steady_clock::now();
+    PathName::sort(names);
+    auto const end = std::chrono::steady_clock::now();
+    std::cout << "PathName::sort: " << std::chrono::duration<double, std::milli>(end - start).count() << " ms"
+              << std::endl;
+
+    run(LegacyPathString(), "legacy traits");
+    run(PathString(), "fold table");
+    run(std::string(), "std::string");
 }
@@ -0,0 +1,141 @@
+#include "Misc/PathNameMap.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+TEST(PathNameMapTest, Hash)
+{
+    std::hash<PathName> const hash;
+    EXPECT_EQ(hash(PathName("Assets\\Textures\\Stone.DDS")), hash(PathName("assets/textures/stone.dds")));
+    EXPECT_NE(hash(PathName("assets/textures/stone.dds")), hash(PathName("assets/textures/stone.png")));
+    EXPECT_NE(hash(PathName("a")), hash(PathName("a\\0")));
+    EXPECT_EQ(std::hash<PathNameView>()("A/B"), hash(PathName("a\\b")));
+
+    // The vector and scalar parts produce the same hash at every length
+    std::string const upper = "ABCDEFGHIJKLMNOPQRSTUVWXYZ/0123456789/ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::string const lower = "abcdefghijklmnopqrstuvwxyz\\0123456789\\abcdefghijklmnopqrstuvwxyz";
+    for (size_t n = 0; n <= upper.size(); ++n)
+    {
+        EXPECT_EQ(char_traits_path_char::hash(upper.data(), n), char_traits_path_char::hash(lower.data(), n)) << n;
+    }
+
+    std::unordered_set<PathName> set { PathName("a/b"), PathName("A\\B"), PathName("c") };
+    EXPECT_EQ(set.size(), 2u);
+}
+
+TEST(PathNameMapTest, Set)
+{
+    PathNameSet set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_TRUE(set.insert("Dir/File.txt").second);
+    EXPECT_FALSE(set.insert("dir\\file.TXT").second);
+    EXPECT_TRUE(set.insert("Dir/Other.txt").second);
+    EXPECT_EQ(set.size(), 2u);
+    EXPECT_TRUE(set.contains("DIR/FILE.TXT"));
+    EXPECT_FALSE(set.contains("Dir/File"));
+    EXPECT_EQ(*set.find("dir/other.txt"), PathName("Dir/Other.txt"));
+
+    EXPECT_TRUE(set.erase("dir/file.txt"));
+    EXPECT_FALSE(set.erase("dir/file.txt"));
+    EXPECT_EQ(set.size(), 1u);
+    EXPECT_TRUE(set.contains("Dir/Other.txt"));
+    EXPECT_TRUE(set.find("Dir/File.txt") == set.end());
+}
+
+TEST(PathNameMapTest, Map)
+{
+    PathNameMap<int> map;
+    EXPECT_TRUE(map.insert("a/b", 1).second);
+    EXPECT_FALSE(map.insert("A\\B", 2).second);
+    EXPECT_EQ(map.find("a/B")->second, 1);
+    map["a/b"] = 3;
+    map["c"]   = 4;
+    EXPECT_EQ(map["A/B"], 3);
+    EXPECT_EQ(map["c"], 4);
+    EXPECT_EQ(map.size(), 2u);
+
+    // Insertion order is kept
+    std::vector<PathName> keys;
+    for (auto const & entry : map)
+    {
+        keys.push_back(entry.first);
+    }
+    EXPECT_EQ(keys, (std::vector<PathName> { PathName("a/b"), PathName("c") }));
+}
+
+TEST(PathNameMapTest, Many)
+{
+    // Insert and erase enough entries to rehash several times and to shift probe sequences
+    PathNameMap<size_t> map;
+    size_t const        n = 20000;
+    for (size_t i = 0; i < n; ++i)
+    {
+        map[("Dir" + std::to_string(i % 97) + "/File" + std::to_string(i)).c_str()] = i;
+    }
+    EXPECT_EQ(map.size(), n);
+    for (size_t i = 0; i < n; i += 2)
+    {
+        EXPECT_TRUE(map.erase(("dir" + std::to_string(i % 97) + "\\file" + std::to_string(i)).c_str()));
+    }
+    EXPECT_EQ(map.size(), n / 2);
+    for (size_t i = 0; i < n; ++i)
+    {
+        auto const entry = map.find(("DIR" + std::to_string(i % 97) + "/FILE" + std::to_string(i)).c_str());
+        if (i % 2 == 0)
+        {
+            EXPECT_TRUE(entry == map.end()) << i;
+        }
+        else
+        {
+            ASSERT_TRUE(entry != map.end()) << i;
+            EXPECT_EQ(entry->second, i);
+        }
+    }
+
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_FALSE(map.contains("Dir1/File1"));
+}
+
+TEST(PathNameMapTest, DISABLED_Benchmark)
+{
+    // Compares lookups with std::map. Run with --gtest_also_run_disabled_tests.
+    std::vector<PathName> paths;
+    for (int i = 0; i < 1000000; ++i)
+    {
+        std::string const path = "Assets/Textures/Environment/Level" + std::to_string(i % 50) + "/Material_" +
+                                 std::to_string(i) + ".dds";
+        paths.emplace_back(path.c_str());
+    }
+
+    PathNameMap<int>        map;
+    std::map<PathName, int> tree;
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        map.insert(paths[i], static_cast<int>(i));
+        tree.emplace(paths[i], static_cast<int>(i));
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+    long long  sum   = 0;
+    for (auto const & path : paths)
+    {
+        sum += map.find(path)->second;
+    }
+    auto const middle = std::chrono::steady_clock::now();
+    for (auto const & path : paths)
+    {
+        sum -= tree.find(path)->second;
+    }
+    auto const end = std::chrono::steady_clock::now();
+
+    std::cout << "PathNameMap: " << std::chrono::duration<double, std::milli>(middle - start).count() << " ms, "
+              << "std::map: " << std::chrono::duration<double, std::milli>(end - middle).count() << " ms" << std::endl;
+    EXPECT_EQ(sum, 0);
+}
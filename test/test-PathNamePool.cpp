@@ -0,0 +1,83 @@
+#include "Misc/PathNamePool.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(PathNamePoolTest, Canonicalize)
+{
+    EXPECT_EQ(PathNamePool::canonicalize("Assets\\Textures/Stone.dds"), "ASSETS/TEXTURES/STONE.DDS");
+    EXPECT_EQ(PathNamePool::canonicalize("a//b/./c/"), "A/B/C");
+    EXPECT_EQ(PathNamePool::canonicalize("a/b/../../c"), "C");
+    EXPECT_EQ(PathNamePool::canonicalize("a/../../c"), "../C");
+    EXPECT_EQ(PathNamePool::canonicalize("../../a/.."), "../..");
+    EXPECT_EQ(PathNamePool::canonicalize("/../a"), "/A");
+    EXPECT_EQ(PathNamePool::canonicalize("\\a\\..\\.."), "/");
+    EXPECT_EQ(PathNamePool::canonicalize("a/.."), ".");
+    EXPECT_EQ(PathNamePool::canonicalize(""), ".");
+    EXPECT_EQ(PathNamePool::canonicalize("c:\\x\\..\\y"), "C:/Y");
+    EXPECT_EQ(PathNamePool::canonicalize("..a/b.."), "..A/B..");
+    EXPECT_EQ(PathNamePool::canonicalize("C:/.."), "C:/");
+    EXPECT_EQ(PathNamePool::canonicalize("c:.."), "C:..");
+    EXPECT_EQ(PathNamePool::canonicalize("\\\\srv\\share\\..\\x"), "//SRV/SHARE/X");
+}
+
+TEST(PathNamePoolTest, Intern)
+{
+    PathNamePool pool;
+    PathNamePool::Id const a = pool.intern("Assets\\Textures\\..\\Models\\Tree.fbx");
+    PathNamePool::Id const b = pool.intern("assets/models/tree.FBX");
+    PathNamePool::Id const c = pool.intern("assets/models/rock.fbx");
+    EXPECT_EQ(a, 0u);
+    EXPECT_EQ(b, a);
+    EXPECT_EQ(c, 1u);
+    EXPECT_EQ(pool.size(), 2u);
+    EXPECT_EQ(pool.str(a), "ASSETS/MODELS/TREE.FBX");
+    EXPECT_EQ(pool.str(c).data()[pool.str(c).size()], 0);
+
+    EXPECT_EQ(pool.find("./Assets/Models/Rock.fbx"), c);
+    EXPECT_EQ(pool.find("assets/models/bush.fbx"), PathNamePool::INVALID);
+    EXPECT_EQ(pool.size(), 2u);
+
+    // Roots are kept, so these paths are all different
+    EXPECT_NE(pool.intern("C:/.."), pool.intern("."));
+    EXPECT_NE(pool.intern("//srv/share"), pool.intern("/SRV/SHARE"));
+    EXPECT_EQ(pool.size(), 6u);
+}
+
+TEST(PathNamePoolTest, Threads)
+{
+    // Several threads intern overlapping sets of paths, enough to grow the table several times
+    PathNamePool             pool;
+    int const                n        = 20000;
+    unsigned const           nThreads = 4;
+    std::vector<std::vector<PathNamePool::Id>> ids(nThreads);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < nThreads; ++t)
+    {
+        threads.emplace_back([&pool, &ids, t] () {
+            for (int i = 0; i < n; ++i)
+            {
+                int const k = (i + static_cast<int>(t) * 5000) % n;
+                ids[t].push_back(pool.intern(((t % 2) ? "DIR/file" : "dir\\FILE") + std::to_string(k)));
+            }
+        });
+    }
+    for (auto & thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(pool.size(), static_cast<size_t>(n));
+    for (unsigned t = 0; t < nThreads; ++t)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            int const k = (i + static_cast<int>(t) * 5000) % n;
+            EXPECT_EQ(ids[t][i], pool.find("dir/file" + std::to_string(k)));
+            EXPECT_EQ(pool.str(ids[t][i]), "DIR/FILE" + std::to_string(k));
+        }
+    }
+}
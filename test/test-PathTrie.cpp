@@ -0,0 +1,178 @@
+#include "Misc/PathTrie.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+// Returns the sorted paths under a prefix
+template <typename T>
+std::vector<std::string> under(PathTrie<T> const & trie, char const * prefix)
+{
+    std::vector<std::string> paths;
+    trie.forEachUnder(prefix, [&paths] (std::string_view path, T const &) { paths.emplace_back(path); });
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+} // anonymous namespace
+
+TEST(PathTrieTest, Insert)
+{
+    PathTrie<int> trie;
+    EXPECT_TRUE(trie.empty());
+    EXPECT_TRUE(trie.insert("Assets/Textures/Stone.dds", 1).second);
+    EXPECT_FALSE(trie.insert("assets\\textures\\STONE.DDS", 2).second);
+    EXPECT_TRUE(trie.insert("Assets/Textures/Grass.dds", 3).second);    // Splits the first node
+    EXPECT_TRUE(trie.insert("Assets", 4).second);                       // Splits again, at a node without a value
+    EXPECT_TRUE(trie.insert("/Assets", 5).second);                      // Absolute paths are different
+    EXPECT_TRUE(trie.insert("", 6).second);
+    EXPECT_EQ(trie.size(), 5u);
+
+    ASSERT_NE(trie.find("ASSETS/TEXTURES/STONE.DDS"), nullptr);
+    EXPECT_EQ(*trie.find("ASSETS/TEXTURES/STONE.DDS"), 1);
+    EXPECT_EQ(*trie.find("assets//textures/grass.dds"), 3);
+    EXPECT_EQ(*trie.find("assets"), 4);
+    EXPECT_EQ(*trie.find("\\assets\\"), 5);
+    EXPECT_EQ(*trie.find(""), 6);
+    EXPECT_FALSE(trie.contains("Assets/Textures"));
+    EXPECT_FALSE(trie.contains("Assets/Textures/Stone"));
+    EXPECT_FALSE(trie.contains("Assets/Textures/Stone.dds/x"));
+    EXPECT_FALSE(trie.contains("/Assets/Textures/Stone.dds"));
+
+    trie["assets/textures"] = 7;
+    EXPECT_EQ(trie["Assets/Textures"], 7);
+    EXPECT_EQ(trie.size(), 6u);
+
+    trie.clear();
+    EXPECT_TRUE(trie.empty());
+    EXPECT_FALSE(trie.contains("Assets"));
+    EXPECT_TRUE(trie.insert("Assets", 8).second);
+}
+
+TEST(PathTrieTest, ForEachUnder)
+{
+    PathTrie<int> trie;
+    trie.insert("Assets/Textures/Stone.dds", 0);
+    trie.insert("Assets/Textures/Grass.dds", 0);
+    trie.insert("Assets/Textures/Trees/Oak.dds", 0);
+    trie.insert("Assets/TexturesOld/Stone.dds", 0);
+    trie.insert("Assets/Models/Tree.fbx", 0);
+    trie.insert("/Tmp/x", 0);
+
+    EXPECT_EQ(under(trie, "assets\\textures"),
+              (std::vector<std::string> { "Assets/Textures/Grass.dds",
+                                          "Assets/Textures/Stone.dds",
+                                          "Assets/Textures/Trees/Oak.dds" }));
+    EXPECT_EQ(under(trie, "Assets/Textures/Trees"), (std::vector<std::string> { "Assets/Textures/Trees/Oak.dds" }));
+    EXPECT_EQ(under(trie, "Assets/Models/Tree.fbx"), (std::vector<std::string> { "Assets/Models/Tree.fbx" }));
+    EXPECT_EQ(under(trie, "/"), (std::vector<std::string> { "/Tmp/x" }));
+    EXPECT_EQ(under(trie, "").size(), 6u);
+    EXPECT_TRUE(under(trie, "Assets/Tex").empty());
+    EXPECT_TRUE(under(trie, "Assets/Textures/Stone.dds/x").empty());
+    EXPECT_TRUE(under(trie, "Tmp").empty());
+}
+
+TEST(PathTrieTest, LongestPrefix)
+{
+    PathTrie<std::string> mounts;
+    mounts.insert("/data", "data");
+    mounts.insert("/data/cache", "cache");
+    mounts.insert("C:\\Games", "games");
+
+    auto mount = mounts.longestPrefix("/Data/Cache/Shaders/Water.bin");
+    ASSERT_NE(mount.first, nullptr);
+    EXPECT_EQ(*mount.first, "cache");
+    EXPECT_EQ(mount.second, "Shaders/Water.bin");
+
+    mount = mounts.longestPrefix("/data/cached/x");
+    ASSERT_NE(mount.first, nullptr);
+    EXPECT_EQ(*mount.first, "data");
+    EXPECT_EQ(mount.second, "cached/x");
+
+    mount = mounts.longestPrefix("c:/games//");
+    ASSERT_NE(mount.first, nullptr);
+    EXPECT_EQ(*mount.first, "games");
+    EXPECT_EQ(mount.second, "");
+
+    mount = mounts.longestPrefix("/dat/x");
+    EXPECT_EQ(mount.first, nullptr);
+    EXPECT_EQ(mount.second, "/dat/x");
+
+    mounts.insert("/", "root");
+    mount = mounts.longestPrefix("/dat/x");
+    ASSERT_NE(mount.first, nullptr);
+    EXPECT_EQ(*mount.first, "root");
+    EXPECT_EQ(mount.second, "dat/x");
+}
+
+TEST(PathTrieTest, Many)
+{
+    // Enough paths to grow the table of edges several times, with directories split after their children are added
+    PathTrie<size_t> trie;
+    size_t const     n = 20000;
+    for (size_t i = 0; i < n; ++i)
+    {
+        std::string const path = "Root/Dir" + std::to_string(i % 7) + "/Sub" + std::to_string(i % 13) + "/File" +
+                                 std::to_string(i);
+        EXPECT_TRUE(trie.insert(path.c_str(), i).second);
+    }
+    EXPECT_EQ(trie.size(), n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        std::string const path = "ROOT/DIR" + std::to_string(i % 7) + "/SUB" + std::to_string(i % 13) + "/FILE" +
+                                 std::to_string(i);
+        size_t const * value = trie.find(path.c_str());
+        ASSERT_NE(value, nullptr) << i;
+        EXPECT_EQ(*value, i);
+    }
+
+    size_t count = 0;
+    trie.forEachUnder("root/dir3/sub5", [&count] (std::string_view path, size_t const & i) {
+        EXPECT_EQ(path, "Root/Dir3/Sub5/File" + std::to_string(i));
+        EXPECT_EQ(i % 7, 3u);
+        EXPECT_EQ(i % 13, 5u);
+        ++count;
+    });
+    size_t expected = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (i % 7 == 3 && i % 13 == 5)
+            ++expected;
+    }
+    EXPECT_EQ(count, expected);
+}
+
+TEST(PathTrieTest, DISABLED_Benchmark)
+{
+    // Compares finding the paths under a directory with a linear scan. Run with --gtest_also_run_disabled_tests.
+    std::vector<PathName> paths;
+    PathTrie<int>         trie;
+    for (int i = 0; i < 1000000; ++i)
+    {
+        std::string const path = "Assets/Textures/Environment/Level" + std::to_string(i % 500) + "/Material_" +
+                                 std::to_string(i) + ".dds";
+        paths.emplace_back(path.c_str());
+        trie.insert(paths.back(), i);
+    }
+
+    PathName const prefix("assets/textures/environment/level42/");
+    auto const     start = std::chrono::steady_clock::now();
+    size_t         found = 0;
+    for (auto const & path : paths)
+    {
+        if (path.compare(0, prefix.size(), prefix) == 0)
+            ++found;
+    }
+    auto const middle = std::chrono::steady_clock::now();
+    trie.forEachUnder(PathNameView(prefix), [&found] (std::string_view, int const &) { --found; });
+    auto const end = std::chrono::steady_clock::now();
+
+    std::cout << "Linear scan: " << std::chrono::duration<double, std::milli>(middle - start).count() << " ms, "
+              << "PathTrie: " << std::chrono::duration<double, std::milli>(end - middle).count() << " ms" << std::endl;
+    EXPECT_EQ(found, 0u);
+}
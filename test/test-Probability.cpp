@@ -37,3 +37,44 @@ TEST(ProbabilityTest, Multisets)
     EXPECT_EQ(multisets( 2,  3),    4);
     EXPECT_EQ(multisets( 4, 18), 1330);
 }
+
+TEST(ProbabilityTest, Large)
+{
+    EXPECT_EQ(combinations(1000,      3), 166167000);
+    EXPECT_EQ(combinations(10000,     5), 832500291625002000);
+    EXPECT_EQ(combinations(10000,  9995), 832500291625002000);
+    EXPECT_EQ(combinations(100000,    4), 4166416671249975000);
+    EXPECT_EQ(combinations(3000,      6), 1007447054065924500);
+    EXPECT_EQ(combinations(66,       33), 7219428434016265740);
+    EXPECT_EQ(permutations(1000,      6), 985084775273880000);
+    EXPECT_EQ(multisets(1000,         4), 41917125250);
+    EXPECT_EQ(combinations(INT64_MAX, 1), INT64_MAX);
+    EXPECT_EQ(combinations(INT64_MAX, INT64_MAX - 1), INT64_MAX);
+}
+
+TEST(ProbabilityTest, Checked)
+{
+    EXPECT_EQ(checkedFactorial(20), 2432902008176640000);
+    EXPECT_FALSE(checkedFactorial(21).has_value());
+    EXPECT_EQ(checkedPermutations(20, 20), 2432902008176640000);
+    EXPECT_FALSE(checkedPermutations(21, 20).has_value());
+    EXPECT_EQ(checkedPermutations(INT64_MAX, 0), 1);
+    EXPECT_EQ(permutations(INT64_MAX, 0), 1);
+    EXPECT_EQ(checkedPermutations(INT64_MAX, 1), INT64_MAX);
+    EXPECT_EQ(checkedCombinations(66, 33), 7219428434016265740);
+    EXPECT_FALSE(checkedCombinations(67, 33).has_value());
+    EXPECT_FALSE(checkedCombinations(4000, 2000).has_value());
+    EXPECT_FALSE(checkedMultisets(INT64_MAX, 2).has_value());
+    EXPECT_EQ(checkedMultisets(INT64_MAX, 1), INT64_MAX);
+
+    // Overflow saturates in the unchecked versions
+    EXPECT_EQ(factorial(21), INT64_MAX);
+    EXPECT_EQ(combinations(67, 33), INT64_MAX);
+
+    // Out of range arguments
+    EXPECT_EQ(checkedCombinations(5, 7), 0);
+    EXPECT_EQ(checkedCombinations(5, -1), 0);
+    EXPECT_EQ(checkedPermutations(5, 6), 0);
+    EXPECT_EQ(checkedMultisets(0, 0), 1);
+    EXPECT_EQ(checkedMultisets(0, 3), 0);
+}
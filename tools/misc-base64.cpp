@@ -0,0 +1,314 @@
+// misc-base64 - Encodes or decodes a file using Base64, and reports the throughput.
+//
+// The input file is memory-mapped and the output file is preallocated and memory-mapped, so the data is never copied
+// into an intermediate buffer. This makes the tool useful both for large files and as an end-to-end benchmark of the
+// codec.
+
+#include "Misc/Base64.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+// A file mapped into memory. An output file is created (or truncated) with the specified size, and can be truncated
+// to its final size when it is closed.
+class MappedFile
+{
+public:
+
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    // Maps an existing file for reading
+    bool openForReading(char const * path);
+
+    // Creates a file of the given size and maps it for writing
+    bool openForWriting(char const * path, size_t size);
+
+    // Unmaps the file. If size is less than the mapped size, the file is truncated to it. Returns false if the file
+    // could not be truncated or closed.
+    bool close(size_t size = SIZE_MAX);
+
+    char * data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+
+    // non-copyable
+    MappedFile(MappedFile const &) = delete;
+    MappedFile & operator =(MappedFile const &) = delete;
+
+    char * data_ = nullptr;
+    size_t size_ = 0;
+#if defined(WIN32)
+    HANDLE file_    = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+#if defined(WIN32)
+
+bool MappedFile::openForReading(char const * path)
+{
+    file_ = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size))
+        return false;
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (size_ == 0)
+        return true;
+
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_)
+        return false;
+    data_ = static_cast<char *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    return data_ != nullptr;
+}
+
+bool MappedFile::openForWriting(char const * path, size_t size)
+{
+    file_ = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE)
+        return false;
+    size_ = size;
+    if (size_ == 0)
+        return true;
+
+    LARGE_INTEGER s;
+    s.QuadPart = static_cast<LONGLONG>(size);
+    mapping_   = CreateFileMappingA(file_, nullptr, PAGE_READWRITE, s.HighPart, s.LowPart, nullptr);
+    if (!mapping_)
+        return false;
+    data_ = static_cast<char *>(MapViewOfFile(mapping_, FILE_MAP_WRITE, 0, 0, 0));
+    return data_ != nullptr;
+}
+
+bool MappedFile::close(size_t size)
+{
+    bool ok = true;
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mapping_)
+        CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE)
+    {
+        if (size < size_)
+        {
+            LARGE_INTEGER s;
+            s.QuadPart = static_cast<LONGLONG>(size);
+            ok         = SetFilePointerEx(file_, s, nullptr, FILE_BEGIN) && SetEndOfFile(file_);
+        }
+        ok = CloseHandle(file_) && ok;
+    }
+    data_    = nullptr;
+    mapping_ = nullptr;
+    file_    = INVALID_HANDLE_VALUE;
+    return ok;
+}
+
+#else // defined(WIN32)
+
+bool MappedFile::openForReading(char const * path)
+{
+    fd_ = ::open(path, O_RDONLY);
+    if (fd_ < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(fd_, &status) != 0)
+        return false;
+    size_ = static_cast<size_t>(status.st_size);
+    if (size_ == 0)
+        return true;
+
+    void * p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (p == MAP_FAILED)
+        return false;
+    madvise(p, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<char *>(p);
+    return true;
+}
+
+bool MappedFile::openForWriting(char const * path, size_t size)
+{
+    fd_ = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd_ < 0)
+        return false;
+    size_ = size;
+    if (size_ == 0)
+        return true;
+
+    if (ftruncate(fd_, static_cast<off_t>(size_)) != 0)
+        return false;
+    void * p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED)
+        return false;
+    data_ = static_cast<char *>(p);
+    return true;
+}
+
+bool MappedFile::close(size_t size)
+{
+    bool ok = true;
+    if (data_)
+        munmap(data_, size_);
+    if (fd_ >= 0)
+    {
+        if (size < size_)
+            ok = ftruncate(fd_, static_cast<off_t>(size)) == 0;
+        ok = ::close(fd_) == 0 && ok;
+    }
+    data_ = nullptr;
+    fd_   = -1;
+    return ok;
+}
+
+#endif // defined(WIN32)
+
+struct Options
+{
+    bool         decode           = false;
+    bool         url              = false;
+    bool         ignoreWhitespace = false;
+    bool         quiet            = false;
+    unsigned     nThreads         = 1;
+    char const * input            = nullptr;
+    char const * output           = nullptr;
+};
+
+void usage()
+{
+    fprintf(stderr,
+            "usage: misc-base64 [-d] [-u] [-w] [-t threads] [-q] input output\n"
+            "\n"
+            "  -d          Decode (the default is to encode)\n"
+            "  -u          Use the URL-safe alphabet without padding\n"
+            "  -w          Ignore whitespace when decoding (single-threaded only)\n"
+            "  -t threads  Number of threads to use (0 means all cores, the default is 1)\n"
+            "  -q          Do not report the throughput\n");
+}
+
+bool parseOptions(int argc, char ** argv, Options & options)
+{
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != 0; ++i)
+    {
+        if (strcmp(argv[i], "-d") == 0)
+            options.decode = true;
+        else if (strcmp(argv[i], "-u") == 0)
+            options.url = true;
+        else if (strcmp(argv[i], "-w") == 0)
+            options.ignoreWhitespace = true;
+        else if (strcmp(argv[i], "-q") == 0)
+            options.quiet = true;
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            options.nThreads = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+        else
+            return false;
+    }
+    if (argc - i != 2)
+        return false;
+
+    options.input  = argv[i];
+    options.output = argv[i + 1];
+    return true;
+}
+
+// Encodes or decodes the input into the output, and returns the number of bytes written to the output
+template <class Alphabet>
+size_t run(Options const & options, char const * in, size_t size, char * out)
+{
+    if (!options.decode)
+        return Base64::encodeParallel<Alphabet>(reinterpret_cast<unsigned char const *>(in), size, out, options.nThreads);
+    else if (options.ignoreWhitespace)
+        return Base64::decode<Alphabet>(in, size, out, true);
+    else
+        return Base64::decodeParallel<Alphabet>(in, size, reinterpret_cast<unsigned char *>(out), options.nThreads);
+}
+} // anonymous namespace
+
+int main(int argc, char ** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+
+    MappedFile input;
+    if (!input.openForReading(options.input))
+    {
+        perror(options.input);
+        return EXIT_FAILURE;
+    }
+
+    size_t const maxSize = options.decode
+                           ? Base64::maxDecodedSize(input.size())
+                           : (options.url ? Base64::encodedSize<Base64::UrlNoPad>(input.size())
+                                          : Base64::encodedSize<Base64::Standard>(input.size()));
+    MappedFile output;
+    if (!output.openForWriting(options.output, maxSize))
+    {
+        perror(options.output);
+        return EXIT_FAILURE;
+    }
+
+    auto const codecStart = std::chrono::steady_clock::now();
+    size_t     size       = 0;
+    if (input.size() > 0)
+    {
+        size = options.url
+               ? run<Base64::UrlNoPad>(options, input.data(), input.size(), output.data())
+               : run<Base64::Standard>(options, input.data(), input.size(), output.data());
+    }
+    auto const codecEnd = std::chrono::steady_clock::now();
+
+    // The output was allocated for the largest possible result, so a failure to truncate it leaves garbage at the end
+    if (!output.close(size))
+    {
+        perror(options.output);
+        return EXIT_FAILURE;
+    }
+    input.close();
+    auto const end = std::chrono::steady_clock::now();
+
+    if (!options.quiet)
+    {
+        double const codecSeconds = std::chrono::duration<double>(codecEnd - codecStart).count();
+        double const totalSeconds = std::chrono::duration<double>(end - start).count();
+        double const gigabytes    = static_cast<double>(input.size()) / 1e9;
+        fprintf(stderr,
+                "%s %zu bytes to %zu bytes: codec %.3f s (%.2f GB/s), total %.3f s (%.2f GB/s)\n",
+                options.decode ? "decoded" : "encoded",
+                input.size(),
+                size,
+                codecSeconds,
+                codecSeconds > 0.0 ? gigabytes / codecSeconds : 0.0,
+                totalSeconds,
+                totalSeconds > 0.0 ? gigabytes / totalSeconds : 0.0);
+    }
+
+    return EXIT_SUCCESS;
+}